@@ -0,0 +1,35 @@
+# Command line benchmarks for the mesh kernel.
+# Build with qmake from this directory; no GUI or GL is needed.
+QT -= core gui
+
+TARGET = subdivisionbench
+TEMPLATE = app
+CONFIG += console c++1z
+CONFIG -= app_bundle
+CONFIG += release
+
+INCLUDEPATH += ../include ../src
+LIBS += -lpthread
+
+SOURCES += \
+    subdivisionbench.cpp \
+    ../src/arena.cpp \
+    ../src/circulators.cpp \
+    ../src/face.cpp \
+    ../src/halfedge.cpp \
+    ../src/halfedgemesh.cpp \
+    ../src/jobsystem.cpp \
+    ../src/stenciltable.cpp \
+    ../src/subdivision.cpp \
+    ../src/trace.cpp \
+    ../src/vertex.cpp
+
+HEADERS += \
+    ../src/arena.h \
+    ../src/circulators.h \
+    ../src/halfedgemesh.h \
+    ../src/jobsystem.h \
+    ../src/parallel.h \
+    ../src/stenciltable.h \
+    ../src/subdivision.h \
+    ../src/trace.h
@@ -0,0 +1,201 @@
+// Benchmark suite for the mesh operators, reported as JSON.
+// For each bundled OBJ (cube, dodecahedron, cow) it times parsing, twin
+// matching, Catmull-Clark levels 1 to 4, triangulating every face of
+// the level 1 surface, extruding every face and assembling the draw
+// buffers the way Mesh::create does. Each case runs several times; the
+// report holds the fastest and median wall time, throughput in elements
+// per second and the peak RSS of the process after the case.
+//
+// usage: meshbench [obj dir] [repeats] [threads] > result.json
+
+#include "halfedgemesh.h"
+#include "meshbuffers.h"
+#include "meshbuilder.h"
+#include "objreader.h"
+#include "parallel.h"
+#include "subdivision.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+// peak resident set size of the process in KiB
+static long peakRssKb() {
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS counters;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+        return long(counters.PeakWorkingSetSize / 1024);
+    }
+    return 0;
+#else
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+    return long(usage.ru_maxrss / 1024); // bytes on macOS
+#else
+    return long(usage.ru_maxrss);
+#endif
+#endif
+}
+
+static double msSince(std::chrono::steady_clock::time_point start) {
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+struct Result
+{
+    std::string name; // operation
+    std::string input; // mesh it ran on
+    long long elements; // elements processed per run, the unit of throughput
+    std::string unit; // what the elements are
+    double minMs; // fastest run
+    double medianMs;
+    long peakRssKb;
+};
+
+class Suite
+{
+public:
+    Suite(int repeats)
+        : repeats(repeats)
+    {}
+
+    // times body repeats times; setup runs before every run and is not timed
+    void run(const std::string &name, const std::string &input, long long elements, const std::string &unit,
+             const std::function<void()> &setup, const std::function<void()> &body) {
+        std::vector<double> times;
+        for (int i = 0; i < repeats; i++) {
+            setup();
+            auto start = std::chrono::steady_clock::now();
+            body();
+            times.push_back(msSince(start));
+        }
+        std::sort(times.begin(), times.end());
+        results.push_back({name, input, elements, unit, times.front(), times[times.size() / 2], peakRssKb()});
+        std::fprintf(stderr, "%-14s %-18s %10.3f ms\n", name.c_str(), input.c_str(), times.front());
+    }
+
+    void print(int threads) const {
+        std::printf("{\n");
+        std::printf("  \"threads\": %d,\n", threads);
+        std::printf("  \"repeats\": %d,\n", repeats);
+        std::printf("  \"results\": [\n");
+        for (size_t i = 0; i < results.size(); i++) {
+            const Result &r = results[i];
+            double throughput = r.minMs > 0 ? double(r.elements) / (r.minMs / 1000.0) : 0.0;
+            std::printf("    {\"name\": \"%s\", \"input\": \"%s\", \"elements\": %lld, \"unit\": \"%s\", "
+                        "\"wall_ms_min\": %.4f, \"wall_ms_median\": %.4f, \"throughput_per_s\": %.1f, "
+                        "\"peak_rss_kb\": %ld}%s\n",
+                        r.name.c_str(), r.input.c_str(), r.elements, r.unit.c_str(),
+                        r.minMs, r.medianMs, throughput, r.peakRssKb, i + 1 < results.size() ? "," : "");
+        }
+        std::printf("  ]\n");
+        std::printf("}\n");
+    }
+
+private:
+    int repeats;
+    std::vector<Result> results;
+};
+
+static void copyMesh(const HalfEdgeMesh &from, HalfEdgeMesh &to) {
+    to.heNext = from.heNext;
+    to.heSym = from.heSym;
+    to.heVertex = from.heVertex;
+    to.heFace = from.heFace;
+    to.vertPos = from.vertPos;
+    to.vertHalfEdge = from.vertHalfEdge;
+    to.faceHalfEdge = from.faceHalfEdge;
+    to.faceColor = from.faceColor;
+}
+
+int main(int argc, char **argv) {
+    std::string dir = argc > 1 ? argv[1] : "../../obj_files";
+    int repeats = argc > 2 ? std::max(std::atoi(argv[2]), 1) : 5;
+    int threads = argc > 3 ? std::atoi(argv[3]) : 0;
+    const char *names[] = {"cube", "dodecahedron", "cow"};
+
+    Suite suite(repeats);
+    for (const char *name : names) {
+        std::string path = dir + "/" + name + ".obj";
+        std::string input = std::string(name) + ".obj";
+        ObjReader reader(threads);
+        ObjData obj;
+        if (!reader.read(path, obj)) {
+            std::fprintf(stderr, "cannot read %s: %s\n", path.c_str(), reader.error().c_str());
+            return 1;
+        }
+        HalfEdgeMesh cage;
+        buildHalfEdgeMesh(obj, cage, nullptr, threads);
+
+        suite.run("obj_parse", input, obj.numFaces(), "faces", []() {}, [&]() {
+            ObjData data;
+            reader.read(path, data);
+        });
+        suite.run("twin_matching", input, cage.numHalfEdges(), "halfedges", []() {}, [&]() {
+            HalfEdgeMesh mesh;
+            buildHalfEdgeMesh(obj, mesh, nullptr, threads);
+        });
+
+        HalfEdgeMesh level;
+        copyMesh(cage, level);
+        for (int l = 1; l <= 4; l++) {
+            // timed on the previous level, output halfedges measure the work
+            HalfEdgeMesh refined;
+            CatmullClark(level, threads).refine(refined);
+            suite.run("catmull_clark_" + std::to_string(l), input, refined.numHalfEdges(), "halfedges",
+                      []() {}, [&]() {
+                HalfEdgeMesh out;
+                CatmullClark(level, threads).refine(out);
+            });
+            level.swap(refined);
+        }
+
+        // the refined surface is all quads, so every face is split
+        HalfEdgeMesh quads;
+        CatmullClark(cage, threads).refine(quads);
+        HalfEdgeMesh work;
+        suite.run("triangulate_all", input + "@1", quads.numFaces(), "faces", [&]() { copyMesh(quads, work); }, [&]() {
+            int faces = work.numFaces();
+            for (int f = 0; f < faces; f++) {
+                work.triangulateFace(uint32_t(f));
+            }
+        });
+        suite.run("extrude_all", input, cage.numFaces(), "faces", [&]() { copyMesh(cage, work); }, [&]() {
+            int faces = work.numFaces();
+            for (int f = 0; f < faces; f++) {
+                if (!work.isBoundaryFace(uint32_t(f))) {
+                    work.extrudeFace(uint32_t(f));
+                }
+            }
+        });
+
+        // buffer assembly of Mesh::create on the level 2 surface, without the GL upload
+        HalfEdgeMesh surface2;
+        CatmullClark(quads, threads).refine(surface2);
+        suite.run("mesh_create_buffers", input + "@2", surface2.numHalfEdges(), "corners", []() {}, [&]() {
+            std::vector<uint32_t> faceCornerStart;
+            std::vector<uint32_t> indices;
+            uint32_t nCorners = buildCornerLayout(surface2, faceCornerStart, indices);
+            std::vector<PackedVertex> vertices(nCorners);
+            parallelFor(surface2.numFaces(), threads, [&](int f) {
+                writeFaceCorners(surface2, uint32_t(f), &vertices[faceCornerStart[f]]);
+            });
+        });
+    }
+    suite.print(resolveThreadCount(threads));
+    return 0;
+}
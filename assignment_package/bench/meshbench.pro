@@ -0,0 +1,44 @@
+# Benchmark suite for the mesh operators, writes JSON to stdout.
+# Build with qmake from this directory; no GUI or GL is needed.
+QT -= core gui
+
+TARGET = meshbench
+TEMPLATE = app
+CONFIG += console c++1z
+CONFIG -= app_bundle
+CONFIG += release
+
+INCLUDEPATH += ../include ../src
+LIBS += -lpthread
+win32: LIBS += -lpsapi
+
+SOURCES += \
+    meshbench.cpp \
+    ../src/arena.cpp \
+    ../src/circulators.cpp \
+    ../src/face.cpp \
+    ../src/halfedge.cpp \
+    ../src/halfedgemesh.cpp \
+    ../src/jobsystem.cpp \
+    ../src/mappedfile.cpp \
+    ../src/meshbuffers.cpp \
+    ../src/meshbuilder.cpp \
+    ../src/objreader.cpp \
+    ../src/packedvertex.cpp \
+    ../src/subdivision.cpp \
+    ../src/trace.cpp \
+    ../src/vertex.cpp
+
+HEADERS += \
+    ../src/arena.h \
+    ../src/circulators.h \
+    ../src/halfedgemesh.h \
+    ../src/jobsystem.h \
+    ../src/mappedfile.h \
+    ../src/meshbuffers.h \
+    ../src/meshbuilder.h \
+    ../src/objreader.h \
+    ../src/packedvertex.h \
+    ../src/parallel.h \
+    ../src/subdivision.h \
+    ../src/trace.h
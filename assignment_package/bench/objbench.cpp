@@ -0,0 +1,176 @@
+// Benchmark for OBJ import.
+// Concatenates copies of an OBJ (cow.obj by default) into one file of
+// about a million faces, then loads it with the old QFile/QRegularExpression
+// loop that slot_readObj used and with ObjReader plus buildHalfEdgeMesh at
+// an increasing number of threads. Every ObjReader result is checked to be
+// identical to the serial parse.
+//
+// usage: objbench [file.obj] [faces] [max threads]
+
+#include "halfedgemesh.h"
+#include "meshbuilder.h"
+#include "objreader.h"
+#include "parallel.h"
+#include <QFile>
+#include <QRegularExpression>
+#include <QStringList>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <string>
+
+// the loader slot_readObj had before ObjReader
+static bool legacyReadObj(const QString &filename, HalfEdgeMesh &mesh) {
+    QFile file(filename);
+    if (!file.open(QFile::ReadOnly | QFile::Text)) {
+        return false;
+    }
+    std::map<std::pair<int, int>, uint32_t> symmap;
+    while (!file.atEnd()) {
+        QString line = file.readLine().trimmed();
+        QStringList lineParts = line.split(QRegularExpression("\\s+"));
+        if (lineParts[0].compare("v", Qt::CaseInsensitive) == 0) {
+            mesh.addVertex(glm::vec3(lineParts[1].toFloat(), lineParts[2].toFloat(), lineParts[3].toFloat()));
+        } else if (lineParts[0].compare("f", Qt::CaseInsensitive) == 0) {
+            uint32_t face = mesh.addFace();
+            std::vector<uint32_t> edges;
+            std::vector<int> vertIdx;
+            for (int i = 1; i < lineParts.size(); i++) {
+                uint32_t e = mesh.addHalfEdge();
+                int v = lineParts[i].split("/")[0].toInt() - 1;
+                mesh.heVertex[e] = v;
+                mesh.vertHalfEdge[v] = e;
+                edges.push_back(e);
+                vertIdx.push_back(v);
+            }
+            int count = lineParts.size() - 1;
+            for (int i = 0; i < count; i++) {
+                uint32_t edge = edges[i];
+                mesh.heNext[edge] = edges[(i + 1) % count];
+                mesh.heFace[edge] = face;
+                int prev = vertIdx[(i + count - 1) % count];
+                auto found = symmap.find(std::make_pair(vertIdx[i], prev));
+                if (found == symmap.end()) {
+                    symmap[std::make_pair(prev, vertIdx[i])] = edge;
+                } else {
+                    mesh.heSym[edge] = found->second;
+                    mesh.heSym[found->second] = edge;
+                }
+            }
+            mesh.faceHalfEdge[face] = edges[0];
+        }
+    }
+    return true;
+}
+
+// writes copies of obj until there are at least faces faces
+static bool writeConcatenated(const ObjData &obj, int faces, const char *path) {
+    FILE *out = std::fopen(path, "w");
+    if (!out) {
+        return false;
+    }
+    for (int copy = 0; copy * obj.numFaces() < faces; copy++) {
+        for (const glm::vec3 &p : obj.positions) {
+            std::fprintf(out, "v %.9g %.9g %.9g\n", double(p.x), double(p.y), double(p.z));
+        }
+        for (const glm::vec2 &t : obj.texcoords) {
+            std::fprintf(out, "vt %.9g %.9g\n", double(t.x), double(t.y));
+        }
+        for (const glm::vec3 &n : obj.normals) {
+            std::fprintf(out, "vn %.9g %.9g %.9g\n", double(n.x), double(n.y), double(n.z));
+        }
+        size_t pos = obj.positions.size() * copy + 1;
+        size_t tex = obj.texcoords.size() * copy + 1;
+        size_t nor = obj.normals.size() * copy + 1;
+        for (int f = 0; f < obj.numFaces(); f++) {
+            std::fputc('f', out);
+            for (uint32_t c = obj.faceStart[f]; c < obj.faceStart[f + 1]; c++) {
+                std::fprintf(out, " %zu", obj.facePositions[c] + pos);
+                if (!obj.faceTexcoords.empty() || !obj.faceNormals.empty()) {
+                    std::fputc('/', out);
+                }
+                if (!obj.faceTexcoords.empty() && obj.faceTexcoords[c] != ObjData::NONE) {
+                    std::fprintf(out, "%zu", obj.faceTexcoords[c] + tex);
+                }
+                if (!obj.faceNormals.empty() && obj.faceNormals[c] != ObjData::NONE) {
+                    std::fprintf(out, "/%zu", obj.faceNormals[c] + nor);
+                }
+            }
+            std::fputc('\n', out);
+        }
+    }
+    return std::fclose(out) == 0;
+}
+
+static double msSince(std::chrono::steady_clock::time_point start) {
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+template<typename T>
+static bool sameBytes(const std::vector<T> &a, const std::vector<T> &b) {
+    return a.size() == b.size() && std::memcmp(a.data(), b.data(), a.size() * sizeof(T)) == 0;
+}
+
+static bool sameData(const ObjData &a, const ObjData &b) {
+    return sameBytes(a.positions, b.positions) && sameBytes(a.texcoords, b.texcoords)
+            && sameBytes(a.normals, b.normals) && sameBytes(a.faceStart, b.faceStart)
+            && sameBytes(a.facePositions, b.facePositions) && sameBytes(a.faceTexcoords, b.faceTexcoords)
+            && sameBytes(a.faceNormals, b.faceNormals);
+}
+
+int main(int argc, char **argv) {
+    const char *path = argc > 1 ? argv[1] : "../../obj_files/cow.obj";
+    int faces = argc > 2 ? std::atoi(argv[2]) : 1000000;
+    int maxThreads = argc > 3 ? std::atoi(argv[3]) : resolveThreadCount(0);
+    const char *bigPath = "objbench_concatenated.obj";
+
+    ObjData source;
+    ObjReader reader(1);
+    if (!reader.read(path, source)) {
+        std::fprintf(stderr, "cannot read %s: %s\n", path, reader.error().c_str());
+        return 1;
+    }
+    if (source.numFaces() == 0 || !writeConcatenated(source, faces, bigPath)) {
+        std::fprintf(stderr, "cannot write %s\n", bigPath);
+        return 1;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    HalfEdgeMesh legacy;
+    legacyReadObj(QString(bigPath), legacy);
+    double legacyMs = msSince(start);
+    std::printf("%d faces, %d vertices\n", legacy.numFaces(), legacy.numVertices());
+    std::printf("legacy slot_readObj loop: %10.1f ms\n\n", legacyMs);
+
+    std::printf("%8s %12s %12s %12s\n", "threads", "parse ms", "+build ms", "identical");
+    ObjData serial;
+    bool allIdentical = true;
+    for (int threads = 1; threads <= maxThreads; threads *= 2) {
+        ObjData obj;
+        reader.setThreads(threads);
+        start = std::chrono::steady_clock::now();
+        if (!reader.read(bigPath, obj)) {
+            std::fprintf(stderr, "cannot read %s: %s\n", bigPath, reader.error().c_str());
+            return 1;
+        }
+        double parseMs = msSince(start);
+        HalfEdgeMesh mesh;
+        buildHalfEdgeMesh(obj, mesh, nullptr, threads);
+        double totalMs = msSince(start);
+
+        bool identical = true;
+        if (threads == 1) {
+            serial = obj;
+            identical = sameBytes(mesh.heSym, legacy.heSym) && sameBytes(mesh.heVertex, legacy.heVertex);
+        } else {
+            identical = sameData(obj, serial);
+        }
+        allIdentical = allIdentical && identical;
+        std::printf("%8d %12.1f %12.1f %12s\n", threads, parseMs, totalMs, identical ? "yes" : "NO");
+    }
+    std::remove(bigPath);
+    return allIdentical ? 0 : 2;
+}
@@ -0,0 +1,36 @@
+# OBJ import benchmark.
+# Build with qmake from this directory; only QtCore is needed, for the
+# old QFile based loader it is compared against.
+QT = core
+
+TARGET = objbench
+TEMPLATE = app
+CONFIG += console c++1z
+CONFIG -= app_bundle
+CONFIG += release
+
+INCLUDEPATH += ../include ../src
+LIBS += -lpthread
+
+SOURCES += \
+    objbench.cpp \
+    ../src/arena.cpp \
+    ../src/face.cpp \
+    ../src/halfedge.cpp \
+    ../src/halfedgemesh.cpp \
+    ../src/jobsystem.cpp \
+    ../src/mappedfile.cpp \
+    ../src/meshbuilder.cpp \
+    ../src/objreader.cpp \
+    ../src/trace.cpp \
+    ../src/vertex.cpp
+
+HEADERS += \
+    ../src/arena.h \
+    ../src/halfedgemesh.h \
+    ../src/jobsystem.h \
+    ../src/mappedfile.h \
+    ../src/meshbuilder.h \
+    ../src/objreader.h \
+    ../src/parallel.h \
+    ../src/trace.h
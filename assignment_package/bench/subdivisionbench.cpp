@@ -0,0 +1,189 @@
+// Scaling benchmark for Catmull-Clark subdivision.
+// Subdivides an OBJ (cow.obj by default) to levels 1 through 4 with an
+// increasing number of threads, reports the time of each run and checks
+// that every parallel result is byte-identical to the serial one.
+//
+// It then times the stencil tables: building them, evaluating every
+// refined vertex and re-evaluating after moving one cage vertex, next to
+// a full refine of the edited cage.
+//
+// usage: subdivisionbench [file.obj] [max threads]
+
+#include "halfedgemesh.h"
+#include "subdivision.h"
+#include "stenciltable.h"
+#include "parallel.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+
+// minimal OBJ reader for v and f records
+static bool loadObj(const char *path, HalfEdgeMesh &mesh) {
+    std::ifstream in(path);
+    if (!in) {
+        return false;
+    }
+    std::map<std::pair<uint32_t, uint32_t>, uint32_t> symmap;
+    std::string line;
+    while (std::getline(in, line)) {
+        std::istringstream parts(line);
+        std::string type;
+        parts >> type;
+        if (type == "v") {
+            glm::vec3 pos;
+            parts >> pos.x >> pos.y >> pos.z;
+            mesh.addVertex(pos);
+        } else if (type == "f") {
+            std::vector<uint32_t> verts;
+            std::string corner;
+            while (parts >> corner) {
+                verts.push_back(uint32_t(std::stoi(corner) - 1));
+            }
+            int count = int(verts.size());
+            uint32_t face = mesh.addFace();
+            uint32_t first = uint32_t(mesh.numHalfEdges());
+            for (int i = 0; i < count; i++) {
+                uint32_t e = mesh.addHalfEdge();
+                mesh.heNext[e] = first + (i + 1) % count;
+                mesh.heVertex[e] = verts[i];
+                mesh.heFace[e] = face;
+                mesh.vertHalfEdge[verts[i]] = e;
+            }
+            for (int i = 0; i < count; i++) {
+                uint32_t from = verts[(i + count - 1) % count];
+                auto found = symmap.find(std::make_pair(verts[i], from));
+                if (found == symmap.end()) {
+                    symmap[std::make_pair(from, verts[i])] = first + i;
+                } else {
+                    mesh.heSym[first + i] = found->second;
+                    mesh.heSym[found->second] = first + i;
+                }
+            }
+            mesh.faceHalfEdge[face] = first;
+        }
+    }
+    return true;
+}
+
+static double msSince(std::chrono::steady_clock::time_point start) {
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+template<typename T>
+static bool sameBytes(const std::vector<T> &a, const std::vector<T> &b) {
+    return a.size() == b.size() && std::memcmp(a.data(), b.data(), a.size() * sizeof(T)) == 0;
+}
+
+static bool identical(const HalfEdgeMesh &a, const HalfEdgeMesh &b) {
+    return sameBytes(a.heNext, b.heNext) && sameBytes(a.heSym, b.heSym) &&
+           sameBytes(a.heVertex, b.heVertex) && sameBytes(a.heFace, b.heFace) &&
+           sameBytes(a.vertPos, b.vertPos) && sameBytes(a.vertHalfEdge, b.vertHalfEdge) &&
+           sameBytes(a.faceHalfEdge, b.faceHalfEdge) && sameBytes(a.faceColor, b.faceColor);
+}
+
+int main(int argc, char *argv[]) {
+    const char *path = argc > 1 ? argv[1] : "../../obj_files/cow.obj";
+    int maxThreads = argc > 2 ? std::atoi(argv[2]) : resolveThreadCount(0);
+
+    HalfEdgeMesh cage;
+    if (!loadObj(path, cage)) {
+        std::fprintf(stderr, "could not read %s\n", path);
+        return 1;
+    }
+    std::printf("%s: %d vertices, %d faces, %d cores\n",
+                path, cage.numVertices(), cage.numFaces(), resolveThreadCount(0));
+    std::printf("%6s %8s %10s %10s %8s %10s\n", "level", "threads", "faces", "ms", "speedup", "identical");
+
+    bool allIdentical = true;
+    HalfEdgeMesh input;
+    input.vertPos = cage.vertPos;
+    input.vertHalfEdge = cage.vertHalfEdge;
+    input.heNext = cage.heNext;
+    input.heSym = cage.heSym;
+    input.heVertex = cage.heVertex;
+    input.heFace = cage.heFace;
+    input.faceHalfEdge = cage.faceHalfEdge;
+    input.faceColor = cage.faceColor;
+
+    for (int level = 1; level <= 4; level++) {
+        HalfEdgeMesh serial;
+        double serialMs = 0;
+        for (int threads = 1; threads <= maxThreads; threads *= 2) {
+            HalfEdgeMesh out;
+            auto start = std::chrono::steady_clock::now();
+            CatmullClark(input, threads).refine(out);
+            auto end = std::chrono::steady_clock::now();
+            double ms = std::chrono::duration<double, std::milli>(end - start).count();
+
+            bool same = true;
+            if (threads == 1) {
+                serialMs = ms;
+            } else {
+                same = identical(serial, out);
+                allIdentical = allIdentical && same;
+            }
+            std::printf("%6d %8d %10d %10.2f %8.2f %10s\n",
+                        level, threads, out.numFaces(), ms, serialMs / ms, same ? "yes" : "NO");
+            if (threads == 1) {
+                serial.swap(out);
+            }
+        }
+        input.swap(serial);
+    }
+
+    std::printf("\n%6s %10s %10s %10s %10s %10s %10s\n",
+                "level", "stencils", "terms", "build ms", "eval ms", "edit ms", "refine ms");
+    for (int level = 1; level <= 3; level++) {
+        HalfEdgeMesh refined;
+        StencilTable stencils;
+        auto start = std::chrono::steady_clock::now();
+        stencils.build(cage, level, refined);
+        double buildMs = msSince(start);
+
+        std::vector<glm::vec3> positions;
+        start = std::chrono::steady_clock::now();
+        stencils.evaluate(cage.vertPos, positions);
+        double evalMs = msSince(start);
+
+        // move one cage vertex and update only the rows it influences
+        std::vector<glm::vec3> edited = cage.vertPos;
+        edited[0] += glm::vec3(0.1f, 0.2f, 0.3f);
+        start = std::chrono::steady_clock::now();
+        stencils.evaluateAffected(0, edited, positions);
+        double editMs = msSince(start);
+
+        // the same edit through full refinement, for reference
+        HalfEdgeMesh moved;
+        moved.vertPos = edited;
+        moved.vertHalfEdge = cage.vertHalfEdge;
+        moved.heNext = cage.heNext;
+        moved.heSym = cage.heSym;
+        moved.heVertex = cage.heVertex;
+        moved.heFace = cage.heFace;
+        moved.faceHalfEdge = cage.faceHalfEdge;
+        moved.faceColor = cage.faceColor;
+        start = std::chrono::steady_clock::now();
+        for (int i = 0; i < level; i++) {
+            HalfEdgeMesh out;
+            CatmullClark(moved).refine(out);
+            moved.swap(out);
+        }
+        double refineMs = msSince(start);
+
+        float maxError = 0;
+        for (size_t i = 0; i < positions.size(); i++) {
+            glm::vec3 d = glm::abs(positions[i] - moved.vertPos[i]);
+            maxError = std::max(maxError, std::max(d.x, std::max(d.y, d.z)));
+        }
+        std::printf("%6d %10d %10d %10.2f %10.2f %10.4f %10.2f   max error %g\n",
+                    level, stencils.numStencils(), int(stencils.weights.size()),
+                    buildMs, evalMs, editMs, refineMs, double(maxError));
+    }
+    return allIdentical ? 0 : 2;
+}
@@ -0,0 +1,371 @@
+// Headless batch processing of meshes, no GUI or GL context needed.
+// Loads a mesh, runs the operations given on the command line in order
+// and writes the result. Each step prints its wall time, so runs can be
+// compared between builds.
+//
+// usage: meshtool input [options] [operations] -o output
+//        meshtool --generate shape:a,b,... [options] [operations] -o output
+//
+//   input / output   .obj or .hemesh to read; .obj, .ply or .hemesh to write
+//   -g, --generate   start from a procedural mesh instead of a file:
+//                      grid:NX,NZ  sphere:SEGMENTS,RINGS  torus:MAJOR,MINOR
+//                      cube:N      prism:SIDES
+//   -t, --threads N  threads for every parallel step, 0 (default) uses every core
+//   --compact        drop unused vertices when writing .obj or .ply
+//   -q, --quiet      only print errors
+//   --trace FILE     write a Chrome trace of the run to FILE
+//
+// operations, applied in the order given:
+//   --subdivide N    Catmull-Clark subdivide N times
+//   --triangulate    fan every face into triangles
+//   --extrude F      extrude face F along its normal, "all" extrudes every face
+//   --delete F       delete face F, "odd" deletes every odd numbered face
+
+#include "generators.h"
+#include "halfedgemesh.h"
+#include "hemeshfile.h"
+#include "jobsystem.h"
+#include "meshbuilder.h"
+#include "meshwriter.h"
+#include "objreader.h"
+#include "subdivision.h"
+#include "trace.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+struct Operation
+{
+    enum Type { SUBDIVIDE, TRIANGULATE, EXTRUDE, DELETE_FACE } type;
+    int count; // subdivision levels, or the face to extrude or delete (-1 for every face or every odd face)
+};
+
+struct Options
+{
+    std::string input;
+    std::string generate; // procedural shape used instead of input
+    std::string output;
+    std::string trace; // Chrome trace written after the run, if set
+    int threads = 0;
+    bool compact = false;
+    bool quiet = false;
+    std::vector<Operation> operations;
+};
+
+static void usage() {
+    std::fprintf(stderr,
+                 "usage: meshtool (input | -g shape:a,b) [-t threads] [--compact] [-q] [--trace file]\n"
+                 "                [--subdivide N] [--triangulate] [--extrude F|all]\n"
+                 "                [--delete F|odd] ... -o output\n"
+                 "input is .obj or .hemesh, output is .obj, .ply or .hemesh\n"
+                 "shapes: grid:NX,NZ sphere:SEGMENTS,RINGS torus:MAJOR,MINOR cube:N prism:SIDES\n");
+}
+
+static bool hasExtension(const std::string &path, const char *extension) {
+    size_t length = std::strlen(extension);
+    return path.size() >= length && path.compare(path.size() - length, length, extension) == 0;
+}
+
+// integer argument, false if it is missing or not a number
+static bool readInt(int argc, char **argv, int &i, int &out) {
+    if (i + 1 >= argc) {
+        return false;
+    }
+    char *end;
+    long value = std::strtol(argv[++i], &end, 10);
+    out = int(value);
+    return *end == '\0' && end != argv[i];
+}
+
+static bool parseArguments(int argc, char **argv, Options &options) {
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "-o" || arg == "--output") {
+            if (i + 1 >= argc) {
+                return false;
+            }
+            options.output = argv[++i];
+        } else if (arg == "-t" || arg == "--threads") {
+            if (!readInt(argc, argv, i, options.threads)) {
+                return false;
+            }
+        } else if (arg == "-g" || arg == "--generate") {
+            if (i + 1 >= argc) {
+                return false;
+            }
+            options.generate = argv[++i];
+        } else if (arg == "--trace") {
+            if (i + 1 >= argc) {
+                return false;
+            }
+            options.trace = argv[++i];
+        } else if (arg == "--compact") {
+            options.compact = true;
+        } else if (arg == "-q" || arg == "--quiet") {
+            options.quiet = true;
+        } else if (arg == "--subdivide") {
+            Operation op = {Operation::SUBDIVIDE, 0};
+            if (!readInt(argc, argv, i, op.count) || op.count < 0) {
+                return false;
+            }
+            options.operations.push_back(op);
+        } else if (arg == "--triangulate") {
+            options.operations.push_back({Operation::TRIANGULATE, 0});
+        } else if (arg == "--extrude") {
+            Operation op = {Operation::EXTRUDE, -1};
+            if (i + 1 < argc && std::strcmp(argv[i + 1], "all") == 0) {
+                i++;
+            } else if (!readInt(argc, argv, i, op.count) || op.count < 0) {
+                return false;
+            }
+            options.operations.push_back(op);
+        } else if (arg == "--delete") {
+            Operation op = {Operation::DELETE_FACE, -1};
+            if (i + 1 < argc && std::strcmp(argv[i + 1], "odd") == 0) {
+                i++;
+            } else if (!readInt(argc, argv, i, op.count) || op.count < 0) {
+                return false;
+            }
+            options.operations.push_back(op);
+        } else if (!arg.empty() && arg[0] != '-' && options.input.empty()) {
+            options.input = arg;
+        } else {
+            std::fprintf(stderr, "unknown argument %s\n", arg.c_str());
+            return false;
+        }
+    }
+    return options.input.empty() != options.generate.empty() && !options.output.empty();
+}
+
+// builds a shape given as name:a,b,...
+static bool generateMesh(const Options &options, HalfEdgeMesh &mesh) {
+    const std::string &spec = options.generate;
+    size_t colon = spec.find(':');
+    std::string name = spec.substr(0, colon);
+    int params[2] = {0, 0};
+    int count = 0;
+    if (colon != std::string::npos) {
+        const char *p = spec.c_str() + colon + 1;
+        while (*p && count < 2) {
+            char *end;
+            params[count++] = int(std::strtol(p, &end, 10));
+            if (end == p) {
+                count = -1;
+                break;
+            }
+            p = *end == ',' ? end + 1 : end;
+        }
+    }
+    int needed = name == "grid" || name == "sphere" || name == "torus" ? 2 : 1;
+    if (count != needed) {
+        std::fprintf(stderr, "cannot generate %s\n", spec.c_str());
+        return false;
+    }
+    bool ok;
+    if (name == "grid") {
+        ok = generateGrid(params[0], params[1], mesh, options.threads);
+    } else if (name == "sphere") {
+        ok = generateUVSphere(params[0], params[1], mesh, options.threads);
+    } else if (name == "torus") {
+        ok = generateTorus(params[0], params[1], 0.25f, mesh, options.threads);
+    } else if (name == "cube") {
+        ok = generateCube(params[0], mesh, options.threads);
+    } else if (name == "prism") {
+        ok = generatePrism(params[0], mesh, options.threads);
+    } else {
+        std::fprintf(stderr, "unknown shape %s\n", name.c_str());
+        return false;
+    }
+    if (!ok) {
+        std::fprintf(stderr, "cannot generate %s, the mesh would be too large\n", spec.c_str());
+        return false;
+    }
+    return true;
+}
+
+static bool loadMesh(const Options &options, HalfEdgeMesh &mesh) {
+    if (!options.generate.empty()) {
+        return generateMesh(options, mesh);
+    }
+    if (hasExtension(options.input, ".hemesh")) {
+        HemeshFile file(options.threads);
+        if (!file.read(options.input, mesh)) {
+            std::fprintf(stderr, "cannot read %s: %s\n", options.input.c_str(), file.error().c_str());
+            return false;
+        }
+        return true;
+    }
+    ObjData obj;
+    ObjReader reader(options.threads);
+    if (!reader.read(options.input, obj)) {
+        std::fprintf(stderr, "cannot read %s: %s\n", options.input.c_str(), reader.error().c_str());
+        return false;
+    }
+    MeshBuildReport report;
+    if (!buildHalfEdgeMesh(obj, mesh, &report, options.threads)) {
+        std::fprintf(stderr, "cannot build a mesh from %s\n", options.input.c_str());
+        return false;
+    }
+    if (!report.nonManifoldEdges.empty()) {
+        std::fprintf(stderr, "%zu non-manifold halfedges in %s were left unpaired\n",
+                     report.nonManifoldEdges.size(), options.input.c_str());
+    }
+    return true;
+}
+
+static bool saveMesh(const Options &options, const HalfEdgeMesh &mesh) {
+    if (hasExtension(options.output, ".hemesh")) {
+        HemeshFile file(options.threads);
+        if (!file.write(options.output, mesh)) {
+            std::fprintf(stderr, "cannot write %s: %s\n", options.output.c_str(), file.error().c_str());
+            return false;
+        }
+        return true;
+    }
+    MeshWriter writer;
+    writer.setCompact(options.compact);
+    if (!writer.write(options.output, mesh)) {
+        std::fprintf(stderr, "cannot write %s: %s\n", options.output.c_str(), writer.error().c_str());
+        return false;
+    }
+    return true;
+}
+
+static bool run(const Operation &op, const Options &options, HalfEdgeMesh &mesh) {
+    switch (op.type) {
+    case Operation::SUBDIVIDE:
+        for (int i = 0; i < op.count; i++) {
+            HalfEdgeMesh refined;
+            CatmullClark(mesh, options.threads).refine(refined);
+            mesh.swap(refined);
+        }
+        return true;
+    case Operation::TRIANGULATE: {
+        // new faces are appended and are already triangles
+        int faces = mesh.numFaces();
+        for (int f = 0; f < faces; f++) {
+            mesh.triangulateFace(uint32_t(f));
+        }
+        return true;
+    }
+    case Operation::EXTRUDE: {
+        if (op.count >= mesh.numFaces()) {
+            std::fprintf(stderr, "cannot extrude face %d, the mesh has %d faces\n", op.count, mesh.numFaces());
+            return false;
+        }
+        int first = op.count < 0 ? 0 : op.count;
+        int last = op.count < 0 ? mesh.numFaces() : op.count + 1;
+        int skipped = 0;
+        for (int f = first; f < last; f++) {
+            // extrudeFace leaves faces on a boundary as they are
+            if (mesh.isBoundaryFace(uint32_t(f))) {
+                skipped += 1;
+            } else {
+                mesh.extrudeFace(uint32_t(f));
+            }
+        }
+        if (skipped > 0) {
+            std::fprintf(stderr, "skipped %d faces on a boundary\n", skipped);
+        }
+        return op.count < 0 || skipped == 0;
+    }
+    case Operation::DELETE_FACE: {
+        if (op.count >= mesh.numFaces()) {
+            std::fprintf(stderr, "cannot delete face %d, the mesh has %d faces\n", op.count, mesh.numFaces());
+            return false;
+        }
+        // deleting only frees slots, the ids close up once at the end
+        if (op.count < 0) {
+            for (int f = 1; f < mesh.numFaces(); f += 2) {
+                mesh.deleteFace(uint32_t(f));
+            }
+        } else {
+            mesh.deleteFace(uint32_t(op.count));
+        }
+        mesh.compact();
+        return true;
+    }
+    }
+    return false;
+}
+
+static const char *describe(const Operation &op) {
+    switch (op.type) {
+    case Operation::SUBDIVIDE:
+        return "subdivide";
+    case Operation::TRIANGULATE:
+        return "triangulate";
+    case Operation::EXTRUDE:
+        return "extrude";
+    case Operation::DELETE_FACE:
+        return "delete";
+    }
+    return "";
+}
+
+static double msSince(std::chrono::steady_clock::time_point start) {
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+static void report(const Options &options, const char *step, double ms, const HalfEdgeMesh &mesh) {
+    if (!options.quiet) {
+        std::printf("%-12s %10.1f ms   %d vertices, %d halfedges, %d faces\n",
+                    step, ms, mesh.numVertices(), mesh.numHalfEdges(), mesh.numFaces());
+    }
+}
+
+// load, operations and save, returns the exit code
+static int process(const Options &options) {
+    HalfEdgeMesh mesh;
+    auto start = std::chrono::steady_clock::now();
+    {
+        TRACE_SCOPE("load");
+        if (!loadMesh(options, mesh)) {
+            return 1;
+        }
+    }
+    report(options, "load", msSince(start), mesh);
+
+    for (const Operation &op : options.operations) {
+        start = std::chrono::steady_clock::now();
+        TraceScope scope(describe(op));
+        if (!run(op, options, mesh)) {
+            return 1;
+        }
+        report(options, describe(op), msSince(start), mesh);
+    }
+
+    start = std::chrono::steady_clock::now();
+    {
+        TRACE_SCOPE("save");
+        if (!saveMesh(options, mesh)) {
+            return 1;
+        }
+    }
+    report(options, "save", msSince(start), mesh);
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    Options options;
+    if (!parseArguments(argc, argv, options)) {
+        usage();
+        return 2;
+    }
+    JobSystem::setThreads(options.threads);
+
+    if (!options.trace.empty() && !Trace::start(options.trace)) {
+        std::fprintf(stderr, "cannot trace: %s\n", Trace::error().c_str());
+        return 1;
+    }
+    int result = process(options);
+    if (!options.trace.empty() && !Trace::stop()) {
+        std::fprintf(stderr, "cannot write the trace: %s\n", Trace::error().c_str());
+        return 1;
+    }
+    return result;
+}
@@ -0,0 +1,45 @@
+# Headless command line mesh tool, built from the same kernel sources
+# as the editor. Build with qmake from this directory; no GUI or GL is needed.
+QT -= core gui
+
+TARGET = meshtool
+TEMPLATE = app
+CONFIG += console c++1z
+CONFIG -= app_bundle
+CONFIG += release
+
+INCLUDEPATH += ../include ../src
+LIBS += -lpthread
+
+SOURCES += \
+    meshtool.cpp \
+    ../src/arena.cpp \
+    ../src/circulators.cpp \
+    ../src/face.cpp \
+    ../src/generators.cpp \
+    ../src/halfedge.cpp \
+    ../src/halfedgemesh.cpp \
+    ../src/hemeshfile.cpp \
+    ../src/jobsystem.cpp \
+    ../src/mappedfile.cpp \
+    ../src/meshbuilder.cpp \
+    ../src/meshwriter.cpp \
+    ../src/objreader.cpp \
+    ../src/subdivision.cpp \
+    ../src/trace.cpp \
+    ../src/vertex.cpp
+
+HEADERS += \
+    ../src/arena.h \
+    ../src/circulators.h \
+    ../src/generators.h \
+    ../src/halfedgemesh.h \
+    ../src/hemeshfile.h \
+    ../src/jobsystem.h \
+    ../src/mappedfile.h \
+    ../src/meshbuilder.h \
+    ../src/meshwriter.h \
+    ../src/objreader.h \
+    ../src/parallel.h \
+    ../src/subdivision.h \
+    ../src/trace.h
@@ -6,8 +6,8 @@
 uniform mat4 u_Model;
 uniform mat4 u_ViewProj;
 
-in vec4 vs_Pos;
-in vec4 vs_Col;
+in vec4 vs_Pos; // w is filled in as 1 when only xyz is sent
+in vec4 vs_Col; // RGBA8 colors arrive unpacked to [0, 1]
 
 out vec4 fs_Col;
 
@@ -20,11 +20,15 @@ uniform mat4 u_ViewProj;    // The matrix that defines the camera's transformati
                             // We've written a static matrix for you to use for HW2,
                             // but in HW3 you'll have to generate one yourself
 
-in vec4 vs_Pos;             // The array of vertex positions passed to the shader
+in vec4 vs_Pos;             // The array of vertex positions passed to the shader.
+                            // Interleaved buffers only send xyz, and GL fills in w = 1.
 
-in vec4 vs_Nor;             // The array of vertex normals passed to the shader
+in vec4 vs_Nor;             // The array of vertex normals passed to the shader.
+                            // Interleaved buffers send them packed as 10:10:10:2 and
+                            // GL unpacks them to [-1, 1], so only xyz is meaningful.
 
 in vec4 vs_Col;             // The array of vertex colors passed to the shader.
+                            // Interleaved buffers send RGBA8, unpacked to [0, 1].
 
 out vec3 fs_Pos;
 out vec4 fs_Nor;            // The array of normals that has been transformed by u_ModelInvTr. This is implicitly passed to the fragment shader.
@@ -0,0 +1,119 @@
+#include "arena.h"
+#include <algorithm>
+#include <cstdlib>
+#include <new>
+
+namespace {
+
+// scratch memory kept by a thread between operations
+const size_t scratchKeepBytes = size_t(256) << 20;
+
+char *allocateSlab(size_t bytes) {
+    void *data = std::malloc(bytes);
+    if (!data) {
+        throw std::bad_alloc();
+    }
+    return static_cast<char*>(data);
+}
+
+// first byte at or after p aligned to align, a power of two
+inline size_t alignUp(size_t p, size_t align) {
+    return (p + align - 1) & ~(align - 1);
+}
+
+struct ThreadScratch
+{
+    Arena arena;
+    int open = 0; // scopes that have not ended
+};
+
+thread_local ThreadScratch scratch;
+
+} // namespace
+
+Arena::Arena(size_t slabBytes)
+    : slabBytes(slabBytes), slabs(), current(0), offset(0)
+{}
+
+Arena::~Arena() {
+    for (const Slab &slab : slabs) {
+        std::free(slab.data);
+    }
+}
+
+void *Arena::allocate(size_t bytes, size_t align) {
+    if (!slabs.empty()) {
+        const Slab &slab = slabs[current];
+        size_t begin = alignUp(size_t(slab.data) + offset, align) - size_t(slab.data);
+        if (begin + bytes <= slab.size) {
+            offset = begin + bytes;
+            return slab.data + begin;
+        }
+    }
+
+    // malloc aligns to max_align_t, more than that needs slack
+    size_t needed = bytes + (align > alignof(std::max_align_t) ? align : 0);
+    size_t next = slabs.empty() ? 0 : current + 1;
+    // a slab kept from before reset() that is large enough moves up front
+    auto fits = std::find_if(slabs.begin() + next, slabs.end(), [needed](const Slab &slab) {
+        return slab.size >= needed;
+    });
+    if (fits != slabs.end()) {
+        std::iter_swap(slabs.begin() + next, fits);
+    } else {
+        size_t size = std::max(needed, slabBytes);
+        slabs.insert(slabs.begin() + next, Slab{allocateSlab(size), size});
+    }
+    current = next;
+    const Slab &slab = slabs[current];
+    size_t begin = alignUp(size_t(slab.data), align) - size_t(slab.data);
+    offset = begin + bytes;
+    return slab.data + begin;
+}
+
+void Arena::reset() {
+    current = 0;
+    offset = 0;
+}
+
+void Arena::trim(size_t keepBytes) {
+    // the largest slabs are the most likely to be reused
+    std::sort(slabs.begin(), slabs.end(), [](const Slab &a, const Slab &b) {
+        return a.size > b.size;
+    });
+    size_t kept = 0;
+    size_t count = 0;
+    while (count < slabs.size() && kept + slabs[count].size <= keepBytes) {
+        kept += slabs[count].size;
+        count += 1;
+    }
+    for (size_t i = count; i < slabs.size(); i++) {
+        std::free(slabs[i].data);
+    }
+    slabs.resize(count);
+    current = 0;
+    offset = 0;
+}
+
+size_t Arena::capacity() const {
+    size_t total = 0;
+    for (const Slab &slab : slabs) {
+        total += slab.size;
+    }
+    return total;
+}
+
+ScratchScope::ScratchScope() {
+    scratch.open += 1;
+}
+
+ScratchScope::~ScratchScope() {
+    scratch.open -= 1;
+    if (scratch.open == 0) {
+        scratch.arena.trim(scratchKeepBytes);
+    }
+}
+
+Arena &ScratchScope::arena() const {
+    return scratch.arena;
+}
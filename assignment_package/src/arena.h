@@ -0,0 +1,94 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Slab arena for scratch arrays of trivially destructible types.
+// Allocation bumps an offset in the current slab; a slab that is full
+// is left as it is and the next one is used, so addresses stay stable
+// while the arena grows. Nothing is freed one by one: reset() makes all
+// memory available again in O(1) and keeps the slabs, so the next run
+// reuses memory that is already paged in.
+class Arena
+{
+public:
+    explicit Arena(size_t slabBytes = size_t(1) << 20);
+    ~Arena();
+    Arena(const Arena &) = delete;
+    Arena &operator=(const Arena &) = delete;
+
+    void *allocate(size_t bytes, size_t align = alignof(std::max_align_t));
+
+    template<typename T>
+    T *allocate(size_t count) {
+        return static_cast<T*>(allocate(count * sizeof(T), alignof(T)));
+    }
+
+    void reset(); // every allocation is gone, the slabs are kept
+    void trim(size_t keepBytes); // after reset(), frees slabs beyond keepBytes of capacity
+    size_t capacity() const; // bytes held in slabs
+
+private:
+    struct Slab
+    {
+        char *data;
+        size_t size;
+    };
+
+    size_t slabBytes; // size of a regular slab, larger requests get a slab of their own
+    std::vector<Slab> slabs; // slabs[0, current] are in use
+    size_t current;
+    size_t offset; // first free byte in slabs[current]
+};
+
+// std::allocator replacement handing out arena memory; deallocate does
+// nothing, the memory comes back when the arena is reset.
+template<typename T>
+class ArenaAllocator
+{
+public:
+    typedef T value_type;
+
+    explicit ArenaAllocator(Arena *arena) : arena(arena) {}
+    template<typename U>
+    ArenaAllocator(const ArenaAllocator<U> &other) : arena(other.arena) {}
+
+    T *allocate(size_t count) {
+        return arena->allocate<T>(count);
+    }
+    void deallocate(T *, size_t) {}
+
+    template<typename U>
+    bool operator==(const ArenaAllocator<U> &other) const {
+        return arena == other.arena;
+    }
+    template<typename U>
+    bool operator!=(const ArenaAllocator<U> &other) const {
+        return arena != other.arena;
+    }
+
+    Arena *arena;
+};
+
+template<typename T>
+using ArenaVector = std::vector<T, ArenaAllocator<T>>;
+
+// Marks the calling thread's scratch arena as in use. The arena is reset
+// when the last open scope of the thread closes, so short-lived helpers
+// such as CatmullClark get their temporary arrays from memory that
+// earlier runs already paged in. Scopes may nest and end in any order.
+class ScratchScope
+{
+public:
+    ScratchScope();
+    ~ScratchScope();
+    ScratchScope(const ScratchScope &) = delete;
+    ScratchScope &operator=(const ScratchScope &) = delete;
+
+    Arena &arena() const;
+
+    template<typename T>
+    ArenaAllocator<T> allocator() const {
+        return ArenaAllocator<T>(&arena());
+    }
+};
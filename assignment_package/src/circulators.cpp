@@ -0,0 +1,20 @@
+#include "circulators.h"
+#include "parallel.h"
+
+void computePrevHalfEdges(const HalfEdgeMesh &mesh, uint32_t *prev, int threads) {
+    parallelFor(mesh.numHalfEdges(), threads, [&](int h) {
+        prev[mesh.heNext[h]] = uint32_t(h);
+    });
+}
+
+int vertexValence(const HalfEdgeMesh &mesh, uint32_t v, const uint32_t *prev) {
+    // an open fan has one more edge than faces, its first incoming
+    // halfedge is on the boundary
+    int faces = 0;
+    bool open = false;
+    for (uint32_t he : incomingHalfEdges(mesh, v, prev)) {
+        faces += 1;
+        open = open || mesh.heSym[he] == HalfEdgeMesh::NONE;
+    }
+    return open ? faces + 1 : faces;
+}
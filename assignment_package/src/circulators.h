@@ -0,0 +1,221 @@
+#pragma once
+#include "halfedgemesh.h"
+#include <cstdint>
+#include <iterator>
+
+// Range-for iteration over the one-ring of a vertex and the loop of a
+// face, on element ids:
+//
+//   for (uint32_t f : vertexFaces(mesh, v)) ...
+//
+// Around a vertex the walk starts at vertHalfEdge and turns with
+// sym(next(h)). A boundary stops it, and it then turns the other way
+// from the start with prev(sym(h)) until the other boundary, so every
+// face of the fan is visited once and the cost is O(valence). Without
+// boundary halfedges a step backwards needs the previous halfedge,
+// which costs a walk around that face unless a table from
+// computePrevHalfEdges is passed in.
+//
+// A pinched vertex, where two fans only share the vertex, is seen as
+// the fan that holds vertHalfEdge.
+
+// prev[h] = previous halfedge of h in its face loop, for every halfedge
+void computePrevHalfEdges(const HalfEdgeMesh &mesh, uint32_t *prev, int threads = 0);
+
+// what a ring yields for each halfedge h that points to the vertex
+enum class RingValue
+{
+    INCOMING, // h
+    OUTGOING, // next(h), the halfedge leaving the vertex in the same face
+    FACE // face(h)
+};
+
+template<RingValue value>
+class VertexRing
+{
+public:
+    class iterator
+    {
+    public:
+        typedef std::forward_iterator_tag iterator_category;
+        typedef uint32_t value_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef const uint32_t *pointer;
+        typedef uint32_t reference;
+
+        iterator(const VertexRing *ring, uint32_t curr)
+            : ring(ring), curr(curr), backward(false)
+        {}
+
+        uint32_t operator*() const {
+            const HalfEdgeMesh &mesh = *ring->mesh;
+            switch (value) {
+            case RingValue::OUTGOING:
+                return mesh.heNext[curr];
+            case RingValue::FACE:
+                return mesh.heFace[curr];
+            default:
+                return curr;
+            }
+        }
+
+        iterator &operator++() {
+            const HalfEdgeMesh &mesh = *ring->mesh;
+            const uint32_t NONE = HalfEdgeMesh::NONE;
+            if (!backward) {
+                uint32_t next = mesh.heSym[mesh.heNext[curr]];
+                if (next != NONE) {
+                    curr = next == ring->start ? NONE : next;
+                    return *this;
+                }
+                // a boundary, finish the fan on the other side of the start
+                backward = true;
+                curr = ring->start;
+            }
+            uint32_t sym = mesh.heSym[curr];
+            curr = sym == NONE ? NONE : ring->prevOf(sym);
+            return *this;
+        }
+
+        iterator operator++(int) {
+            iterator old = *this;
+            ++*this;
+            return old;
+        }
+
+        bool operator==(const iterator &other) const {
+            return curr == other.curr;
+        }
+        bool operator!=(const iterator &other) const {
+            return curr != other.curr;
+        }
+
+    private:
+        const VertexRing *ring;
+        uint32_t curr; // halfedge pointing to the vertex, NONE at the end
+        bool backward; // turning back from the start after a boundary
+    };
+
+    // prev may be a table from computePrevHalfEdges, or null to walk the faces
+    VertexRing(const HalfEdgeMesh &mesh, uint32_t vertex, const uint32_t *prev = nullptr)
+        : mesh(&mesh), prev(prev), start(mesh.vertHalfEdge[vertex])
+    {}
+
+    iterator begin() const {
+        return iterator(this, start);
+    }
+    iterator end() const {
+        return iterator(this, HalfEdgeMesh::NONE);
+    }
+
+private:
+    const HalfEdgeMesh *mesh;
+    const uint32_t *prev;
+    uint32_t start; // vertHalfEdge of the vertex
+
+    uint32_t prevOf(uint32_t he) const {
+        return prev ? prev[he] : mesh->prevHalfEdge(he);
+    }
+};
+
+// halfedges pointing to v
+inline VertexRing<RingValue::INCOMING> incomingHalfEdges(const HalfEdgeMesh &mesh, uint32_t v,
+                                                         const uint32_t *prev = nullptr) {
+    return VertexRing<RingValue::INCOMING>(mesh, v, prev);
+}
+
+// halfedges leaving v, one per face around v
+inline VertexRing<RingValue::OUTGOING> outgoingHalfEdges(const HalfEdgeMesh &mesh, uint32_t v,
+                                                         const uint32_t *prev = nullptr) {
+    return VertexRing<RingValue::OUTGOING>(mesh, v, prev);
+}
+
+// faces around v
+inline VertexRing<RingValue::FACE> vertexFaces(const HalfEdgeMesh &mesh, uint32_t v,
+                                               const uint32_t *prev = nullptr) {
+    return VertexRing<RingValue::FACE>(mesh, v, prev);
+}
+
+// number of edges at v
+int vertexValence(const HalfEdgeMesh &mesh, uint32_t v, const uint32_t *prev = nullptr);
+
+// what a face loop yields for each of its halfedges h
+enum class LoopValue
+{
+    HALFEDGE, // h
+    VERTEX // vertex(h)
+};
+
+template<LoopValue value>
+class FaceLoop
+{
+public:
+    class iterator
+    {
+    public:
+        typedef std::forward_iterator_tag iterator_category;
+        typedef uint32_t value_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef const uint32_t *pointer;
+        typedef uint32_t reference;
+
+        iterator(const HalfEdgeMesh *mesh, uint32_t first, uint32_t curr)
+            : mesh(mesh), first(first), curr(curr)
+        {}
+
+        uint32_t operator*() const {
+            return value == LoopValue::VERTEX ? mesh->heVertex[curr] : curr;
+        }
+
+        iterator &operator++() {
+            curr = mesh->heNext[curr];
+            if (curr == first) {
+                curr = HalfEdgeMesh::NONE;
+            }
+            return *this;
+        }
+
+        iterator operator++(int) {
+            iterator old = *this;
+            ++*this;
+            return old;
+        }
+
+        bool operator==(const iterator &other) const {
+            return curr == other.curr;
+        }
+        bool operator!=(const iterator &other) const {
+            return curr != other.curr;
+        }
+
+    private:
+        const HalfEdgeMesh *mesh;
+        uint32_t first; // faceHalfEdge of the face
+        uint32_t curr; // NONE at the end
+    };
+
+    FaceLoop(const HalfEdgeMesh &mesh, uint32_t face)
+        : mesh(&mesh), first(mesh.faceHalfEdge[face])
+    {}
+
+    iterator begin() const {
+        return iterator(mesh, first, first);
+    }
+    iterator end() const {
+        return iterator(mesh, first, HalfEdgeMesh::NONE);
+    }
+
+private:
+    const HalfEdgeMesh *mesh;
+    uint32_t first;
+};
+
+// halfedges of a face in loop order, starting at faceHalfEdge
+inline FaceLoop<LoopValue::HALFEDGE> faceHalfEdges(const HalfEdgeMesh &mesh, uint32_t face) {
+    return FaceLoop<LoopValue::HALFEDGE>(mesh, face);
+}
+
+// vertices of a face in loop order, each the end of the matching halfedge
+inline FaceLoop<LoopValue::VERTEX> faceVertices(const HalfEdgeMesh &mesh, uint32_t face) {
+    return FaceLoop<LoopValue::VERTEX>(mesh, face);
+}
@@ -1,9 +1,12 @@
 #include "drawable.h"
 #include <la.h>
+#include <cstddef>
 
 Drawable::Drawable(OpenGLContext* context)
-    : count(-1), bufIdx(), bufPos(), bufNor(), bufCol(),
-      idxBound(false), posBound(false), norBound(false), colBound(false),
+    : count(-1), bufIdx(), bufPos(), bufNor(), bufCol(), bufInterleaved(), vao(),
+      idxBound(false), posBound(false), norBound(false), colBound(false), interleavedBound(false),
+      vaoBound(false), vaoReady(false),
+      idxBytes(0), posBytes(0), norBytes(0), colBytes(0), interleavedBytes(0),
       mp_context(context)
 {}
 
@@ -18,6 +21,24 @@ void Drawable::destroy()
     mp_context->glDeleteBuffers(1, &bufPos);
     mp_context->glDeleteBuffers(1, &bufNor);
     mp_context->glDeleteBuffers(1, &bufCol);
+    mp_context->glDeleteBuffers(1, &bufInterleaved);
+    if (vaoBound) {
+        mp_context->glDeleteVertexArrays(1, &vao);
+        mp_context->vertexArrayDeleted(vao);
+    }
+    // the handles are gone, generate*() has to run again before binding
+    idxBound = false;
+    posBound = false;
+    norBound = false;
+    colBound = false;
+    interleavedBound = false;
+    vaoBound = false;
+    vaoReady = false;
+    idxBytes = 0;
+    posBytes = 0;
+    norBytes = 0;
+    colBytes = 0;
+    interleavedBytes = 0;
 }
 
 GLenum Drawable::drawMode()
@@ -39,8 +60,15 @@ int Drawable::elemCount()
 void Drawable::generateIdx()
 {
     idxBound = true;
+    // The index buffer binding is part of the vertex array, so the
+    // Drawable needs its own vertex array before the index buffer is bound
+    if (!vaoBound) {
+        vaoBound = true;
+        mp_context->glGenVertexArrays(1, &vao);
+    }
     // Create a VBO on our GPU and store its handle in bufIdx
     mp_context->glGenBuffers(1, &bufIdx);
+    vaoReady = false;
 }
 
 void Drawable::generatePos()
@@ -48,6 +76,7 @@ void Drawable::generatePos()
     posBound = true;
     // Create a VBO on our GPU and store its handle in bufPos
     mp_context->glGenBuffers(1, &bufPos);
+    vaoReady = false;
 }
 
 void Drawable::generateNor()
@@ -55,6 +84,7 @@ void Drawable::generateNor()
     norBound = true;
     // Create a VBO on our GPU and store its handle in bufNor
     mp_context->glGenBuffers(1, &bufNor);
+    vaoReady = false;
 }
 
 void Drawable::generateCol()
@@ -62,11 +92,21 @@ void Drawable::generateCol()
     colBound = true;
     // Create a VBO on our GPU and store its handle in bufCol
     mp_context->glGenBuffers(1, &bufCol);
+    vaoReady = false;
+}
+
+void Drawable::generateInterleaved()
+{
+    interleavedBound = true;
+    // Create a VBO on our GPU and store its handle in bufInterleaved
+    mp_context->glGenBuffers(1, &bufInterleaved);
+    vaoReady = false;
 }
 
 bool Drawable::bindIdx()
 {
     if(idxBound) {
+        mp_context->bindVertexArray(vao);
         mp_context->glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, bufIdx);
     }
     return idxBound;
@@ -95,3 +135,99 @@ bool Drawable::bindCol()
     }
     return colBound;
 }
+
+bool Drawable::bindInterleaved()
+{
+    if(interleavedBound){
+        mp_context->glBindBuffer(GL_ARRAY_BUFFER, bufInterleaved);
+    }
+    return interleavedBound;
+}
+
+void Drawable::uploadIdx(GLsizeiptr bytes, const void *data, GLenum usage)
+{
+    if (bindIdx()) {
+        mp_context->glBufferData(GL_ELEMENT_ARRAY_BUFFER, bytes, data, usage);
+        idxBytes = bytes;
+    }
+}
+
+void Drawable::uploadPos(GLsizeiptr bytes, const void *data, GLenum usage)
+{
+    if (bindPos()) {
+        mp_context->glBufferData(GL_ARRAY_BUFFER, bytes, data, usage);
+        posBytes = bytes;
+    }
+}
+
+void Drawable::uploadNor(GLsizeiptr bytes, const void *data, GLenum usage)
+{
+    if (bindNor()) {
+        mp_context->glBufferData(GL_ARRAY_BUFFER, bytes, data, usage);
+        norBytes = bytes;
+    }
+}
+
+void Drawable::uploadCol(GLsizeiptr bytes, const void *data, GLenum usage)
+{
+    if (bindCol()) {
+        mp_context->glBufferData(GL_ARRAY_BUFFER, bytes, data, usage);
+        colBytes = bytes;
+    }
+}
+
+void Drawable::uploadInterleaved(GLsizeiptr bytes, const void *data, GLenum usage)
+{
+    if (bindInterleaved()) {
+        mp_context->glBufferData(GL_ARRAY_BUFFER, bytes, data, usage);
+        interleavedBytes = bytes;
+    }
+}
+
+size_t Drawable::gpuBytes() const
+{
+    return size_t(idxBytes + posBytes + norBytes + colBytes + interleavedBytes);
+}
+
+void Drawable::bindVertexArray()
+{
+    if (!vaoBound) {
+        vaoBound = true;
+        mp_context->glGenVertexArrays(1, &vao);
+    }
+    mp_context->bindVertexArray(vao);
+    if (vaoReady) {
+        return;
+    }
+
+    // Attribute pointers capture the buffer bound to GL_ARRAY_BUFFER,
+    // so this only has to run again after a buffer is generated
+    if (bindInterleaved()) {
+        // Missing components are filled in by GL, so vs_Pos still gets w = 1.
+        GLsizei stride = sizeof(PackedVertex);
+        mp_context->glEnableVertexAttribArray(ATTR_POS);
+        mp_context->glVertexAttribPointer(ATTR_POS, 3, GL_FLOAT, false, stride,
+                                          (void*)offsetof(PackedVertex, pos));
+        mp_context->glEnableVertexAttribArray(ATTR_NOR);
+        mp_context->glVertexAttribPointer(ATTR_NOR, 4, GL_INT_2_10_10_10_REV, true, stride,
+                                          (void*)offsetof(PackedVertex, nor));
+        mp_context->glEnableVertexAttribArray(ATTR_COL);
+        mp_context->glVertexAttribPointer(ATTR_COL, 4, GL_UNSIGNED_BYTE, true, stride,
+                                          (void*)offsetof(PackedVertex, col));
+    } else {
+        if (bindPos()) {
+            mp_context->glEnableVertexAttribArray(ATTR_POS);
+            mp_context->glVertexAttribPointer(ATTR_POS, 4, GL_FLOAT, false, 0, nullptr);
+        }
+        if (bindNor()) {
+            mp_context->glEnableVertexAttribArray(ATTR_NOR);
+            mp_context->glVertexAttribPointer(ATTR_NOR, 4, GL_FLOAT, false, 0, nullptr);
+        }
+        if (bindCol()) {
+            mp_context->glEnableVertexAttribArray(ATTR_COL);
+            mp_context->glVertexAttribPointer(ATTR_COL, 4, GL_FLOAT, false, 0, nullptr);
+        }
+    }
+    bindIdx();
+    vaoReady = true;
+}
@@ -2,6 +2,11 @@
 
 #include <openglcontext.h>
 #include <la.h>
+#include "packedvertex.h"
+
+// Attribute locations shared by every shader program, so a vertex array
+// configured once by a Drawable works with any ShaderProgram.
+enum VertexAttribute { ATTR_POS = 0, ATTR_NOR = 1, ATTR_COL = 2 };
 
 //This defines a class which can be rendered by our shader program.
 //Make any geometry a subclass of ShaderProgram::Drawable in order to render it with the ShaderProgram class.
@@ -14,11 +19,23 @@ protected:
     GLuint bufNor; // A Vertex Buffer Object that we will use to store mesh normals (vec4s)
     GLuint bufCol; // Can be used to pass per-vertex color information to the shader, but is currently unused.
                    // Instead, we use a uniform vec4 in the shader to set an overall color for the geometry
+    GLuint bufInterleaved; // A Vertex Buffer Object holding PackedVertex structs, used instead of bufPos/bufNor/bufCol
+    GLuint vao; // Vertex Array Object recording this Drawable's attribute setup and index buffer
 
     bool idxBound; // Set to TRUE by generateIdx(), returned by bindIdx().
     bool posBound;
     bool norBound;
     bool colBound;
+    bool interleavedBound;
+    bool vaoBound; // Set to TRUE once vao has been generated
+    bool vaoReady; // Whether the attribute pointers in vao match the current buffers
+
+    // Sizes of the buffer contents, kept by the upload functions below
+    GLsizeiptr idxBytes;
+    GLsizeiptr posBytes;
+    GLsizeiptr norBytes;
+    GLsizeiptr colBytes;
+    GLsizeiptr interleavedBytes;
 
     OpenGLContext* mp_context; // Since Qt's OpenGL support is done through classes like QOpenGLFunctions_3_2_Core,
                           // we need to pass our OpenGL context to the Drawable in order to call GL functions
@@ -42,9 +59,23 @@ public:
     void generatePos();
     void generateNor();
     void generateCol();
+    void generateInterleaved();
 
     bool bindIdx();
     bool bindPos();
     bool bindNor();
     bool bindCol();
+    bool bindInterleaved();
+
+    // Bind a buffer and replace its contents with glBufferData
+    void uploadIdx(GLsizeiptr bytes, const void *data, GLenum usage);
+    void uploadPos(GLsizeiptr bytes, const void *data, GLenum usage);
+    void uploadNor(GLsizeiptr bytes, const void *data, GLenum usage);
+    void uploadCol(GLsizeiptr bytes, const void *data, GLenum usage);
+    void uploadInterleaved(GLsizeiptr bytes, const void *data, GLenum usage);
+
+    size_t gpuBytes() const; // bytes held in the GL buffers of this Drawable
+
+    // Binds the vertex array, setting up its attribute pointers first if the buffers changed
+    void bindVertexArray();
 };
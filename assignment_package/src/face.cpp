@@ -1,22 +1,39 @@
 #include "face.h"
+#include "halfedgemesh.h"
 
 Face::Face()
-    : QListWidgetItem(), color(float(rand())/float((RAND_MAX)),
-                               float(rand())/float((RAND_MAX)),
-                               float(rand())/float((RAND_MAX)))
-{
-    id = lastFace++;
-    // set text of widget item
-    this->setText(QString::number(this->id));
+    : mesh(nullptr), index(HalfEdgeMesh::NONE), generation(0)
+{}
+
+Face::Face(HalfEdgeMesh *mesh, uint32_t index)
+    : mesh(mesh), index(index), generation(mesh ? mesh->faceGeneration(index) : 0)
+{}
+
+HalfEdge Face::halfedge() const {
+    return HalfEdge(mesh, mesh->faceHalfEdge[index]);
+}
+
+glm::vec3 &Face::color() const {
+    return mesh->faceColor[index];
+}
+
+int Face::id() const {
+    return int(index);
 }
 
 // returns vertex count of face
-int Face::vertexCount() {
-    int count = 0;
-    HalfEdge* curr = halfedge;
-    do {
-        count += 1;
-        curr = curr->next;
-    } while(curr != halfedge);
-    return count;
+int Face::vertexCount() const {
+    return mesh->faceVertexCount(index);
+}
+
+bool Face::isValid() const {
+    return mesh != nullptr && mesh->isFaceAlive(index) && mesh->faceGeneration(index) == generation;
+}
+
+bool Face::operator==(const Face &other) const {
+    return mesh == other.mesh && index == other.index && generation == other.generation;
+}
+
+bool Face::operator!=(const Face &other) const {
+    return !(*this == other);
 }
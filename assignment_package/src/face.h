@@ -1,21 +1,25 @@
 #pragma once
-#include <halfedge.h>
 #include <glm/glm.hpp>
-#include <QListWidgetItem>
+#include <cstdint>
 
+class HalfEdgeMesh;
 class HalfEdge;
 
-static int lastFace;
-
-class Face : public QListWidgetItem
+// Lightweight view of a face stored in a HalfEdgeMesh
+class Face
 {
 public:
-    Face();
-    HalfEdge *halfedge; // any halfedge in the face
-    glm::vec3 color; // color
-    int id; // id of face
-    int vertexCount(); // returns vertex count of face
-
+    Face(); // invalid face
+    Face(HalfEdgeMesh *mesh, uint32_t index);
+    HalfEdge halfedge() const; // any halfedge in the face
+    glm::vec3 &color() const; // color
+    int id() const; // id of face
+    int vertexCount() const; // returns vertex count of face
+    bool isValid() const; // false once the face is removed, even if its slot is reused
+    bool operator==(const Face &other) const;
+    bool operator!=(const Face &other) const;
 
+    HalfEdgeMesh *mesh; // mesh that stores the face
+    uint32_t index; // index of the face in the mesh arrays
+    uint32_t generation; // generation of the slot when the view was made
 };
-
@@ -1,4 +1,5 @@
 #include "facedisplay.h"
+#include "circulators.h"
 
 FaceDisplay::FaceDisplay(OpenGLContext *context)
     : Drawable(context)
@@ -17,45 +18,34 @@ GLenum FaceDisplay::drawMode() {
 // representation of the currently selected Vertex
 void FaceDisplay::create() {
     std::vector<GLuint> idxVec;
-    std::vector<glm::vec4> posVec;
-    std::vector<glm::vec4> colorVec;
-    if (representedFace != nullptr) {
-        int track = 0;
-        HalfEdge *currEdge = representedFace->halfedge;
-        // iterate through faces
-        do {
-            idxVec.push_back(track);
-            idxVec.push_back(track + 1);
-            track += 2;
-            posVec.push_back(glm::vec4(currEdge->vertex->pos, 1));
-            posVec.push_back(glm::vec4(currEdge->sym->vertex->pos, 1));
-            glm::vec4 newColor = glm::vec4(1 - representedFace->color[0],
-                                  1 - representedFace->color[1],
-                                  1 - representedFace->color[2],
-                                  1);
-            colorVec.push_back(newColor);
-            colorVec.push_back(newColor);
-            currEdge = currEdge->next;
-
-        } while (currEdge != representedFace->halfedge);
+    std::vector<PackedVertex> vertVec;
+    if (representedFace.isValid()) {
+        const HalfEdgeMesh &mesh = *representedFace.mesh;
+        glm::vec3 color = glm::vec3(1) - representedFace.color();
+        std::vector<glm::vec3> corners;
+        for (uint32_t v : faceVertices(mesh, representedFace.index)) {
+            corners.push_back(mesh.vertPos[v]);
+        }
+        // one line per edge, from each corner back to the one before it
+        size_t n = corners.size();
+        for (size_t i = 0; i < n; i++) {
+            idxVec.push_back(GLuint(2 * i));
+            idxVec.push_back(GLuint(2 * i + 1));
+            vertVec.push_back(PackedVertex(corners[i], glm::vec3(0), color));
+            vertVec.push_back(PackedVertex(corners[(i + n - 1) % n], glm::vec3(0), color));
+        }
     }
     // vbo update
     count = idxVec.size();
     generateIdx();
-    bindIdx();
-    mp_context->glBufferData(GL_ELEMENT_ARRAY_BUFFER, idxVec.size() * sizeof(GLuint), idxVec.data(), GL_STATIC_DRAW);
+    uploadIdx(idxVec.size() * sizeof(GLuint), idxVec.data(), GL_STATIC_DRAW);
 
-    generatePos();
-    bindPos();
-    mp_context->glBufferData(GL_ARRAY_BUFFER, posVec.size() * sizeof(glm::vec4), posVec.data(), GL_STATIC_DRAW);
-
-    generateCol();
-    bindCol();
-    mp_context->glBufferData(GL_ARRAY_BUFFER, colorVec.size() * sizeof(glm::vec4), colorVec.data(), GL_STATIC_DRAW);
+    generateInterleaved();
+    uploadInterleaved(vertVec.size() * sizeof(PackedVertex), vertVec.data(), GL_STATIC_DRAW);
 
 
 }
 
-void FaceDisplay::updateFace(Face *face) {
+void FaceDisplay::updateFace(Face face) {
     this->representedFace = face;
 }
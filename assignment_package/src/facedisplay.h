@@ -1,18 +1,18 @@
 #pragma once
 #include "drawable.h"
-#include "face.h"
+#include "halfedgemesh.h"
 #include <vector>
 
 class FaceDisplay : public Drawable
 {
 protected:
-    Face *representedFace = nullptr; // the face it points to
+    Face representedFace; // the face it points to
 
 public:
     FaceDisplay(OpenGLContext*);
     ~FaceDisplay();
     GLenum drawMode() override;
     virtual void create() override;
-    void updateFace(Face*); // update with new face
+    void updateFace(Face); // update with new face
 };
 
@@ -0,0 +1,241 @@
+#include "generators.h"
+#include "meshbuilder.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <unordered_map>
+
+namespace {
+
+const float pi = 3.14159265358979f;
+
+// whether a mesh with this many halfedges can be built. Ids must stay
+// below HalfEdgeMesh::NONE and the element counts are ints, so the
+// tighter of the two limits applies. On failure out is emptied, as a
+// failed build would leave it.
+bool fits(uint64_t halfEdges, HalfEdgeMesh &out) {
+    uint64_t limit = std::min<uint64_t>(uint64_t(HalfEdgeMesh::NONE) - 1,
+                                        uint64_t(std::numeric_limits<int>::max()));
+    if (halfEdges > limit) {
+        out.clear();
+        return false;
+    }
+    return true;
+}
+
+// polygon soup the generators fill before building halfedges
+struct Soup
+{
+    std::vector<glm::vec3> positions;
+    std::vector<uint32_t> faceStart;
+    std::vector<uint32_t> faceIndices;
+
+    Soup(size_t vertices, size_t faces, size_t corners) {
+        positions.reserve(vertices);
+        faceStart.reserve(faces + 1);
+        faceIndices.reserve(corners);
+        faceStart.push_back(0);
+    }
+
+    void quad(uint32_t a, uint32_t b, uint32_t c, uint32_t d) {
+        faceIndices.insert(faceIndices.end(), {a, b, c, d});
+        faceStart.push_back(uint32_t(faceIndices.size()));
+    }
+
+    void triangle(uint32_t a, uint32_t b, uint32_t c) {
+        faceIndices.insert(faceIndices.end(), {a, b, c});
+        faceStart.push_back(uint32_t(faceIndices.size()));
+    }
+
+    bool build(HalfEdgeMesh &out, int threads) const {
+        return buildHalfEdgeMesh(positions, faceStart, faceIndices, out, nullptr, threads);
+    }
+};
+
+} // namespace
+
+bool generateGrid(int nx, int nz, HalfEdgeMesh &out, int threads) {
+    nx = std::max(nx, 1);
+    nz = std::max(nz, 1);
+    if (!fits(4 * uint64_t(nx) * uint64_t(nz), out)) {
+        return false;
+    }
+    size_t faces = size_t(nx) * size_t(nz);
+    Soup soup(size_t(nx + 1) * size_t(nz + 1), faces, 4 * faces);
+    // unit square centered on the origin
+    for (int i = 0; i <= nx; i++) {
+        for (int j = 0; j <= nz; j++) {
+            soup.positions.push_back(glm::vec3(float(i) / nx - 0.5f, 0.0f, float(j) / nz - 0.5f));
+        }
+    }
+    auto index = [nz](int i, int j) {
+        return uint32_t(i) * uint32_t(nz + 1) + uint32_t(j);
+    };
+    for (int i = 0; i < nx; i++) {
+        for (int j = 0; j < nz; j++) {
+            soup.quad(index(i, j), index(i, j + 1), index(i + 1, j + 1), index(i + 1, j));
+        }
+    }
+    return soup.build(out, threads);
+}
+
+bool generateUVSphere(int segments, int rings, HalfEdgeMesh &out, int threads) {
+    segments = std::max(segments, 3);
+    rings = std::max(rings, 2);
+    // two fans of triangles and rings - 2 bands of quads
+    if (!fits(6 * uint64_t(segments) + 4 * uint64_t(segments) * uint64_t(rings - 2), out)) {
+        return false;
+    }
+    size_t faces = size_t(segments) * size_t(rings);
+    Soup soup(size_t(segments) * size_t(rings - 1) + 2, faces, 4 * faces);
+
+    // north pole, rings - 1 latitude rings from north to south, south pole
+    soup.positions.push_back(glm::vec3(0, 1, 0));
+    for (int r = 1; r < rings; r++) {
+        float theta = pi * float(r) / float(rings);
+        for (int s = 0; s < segments; s++) {
+            float phi = 2.0f * pi * float(s) / float(segments);
+            soup.positions.push_back(glm::vec3(std::sin(theta) * std::cos(phi), std::cos(theta),
+                                               std::sin(theta) * std::sin(phi)));
+        }
+    }
+    uint32_t south = uint32_t(soup.positions.size());
+    soup.positions.push_back(glm::vec3(0, -1, 0));
+
+    auto index = [segments](int r, int s) {
+        return uint32_t(1 + (r - 1) * segments + s % segments);
+    };
+    for (int s = 0; s < segments; s++) {
+        soup.triangle(0, index(1, s + 1), index(1, s));
+    }
+    for (int r = 1; r + 1 < rings; r++) {
+        for (int s = 0; s < segments; s++) {
+            soup.quad(index(r, s), index(r, s + 1), index(r + 1, s + 1), index(r + 1, s));
+        }
+    }
+    for (int s = 0; s < segments; s++) {
+        soup.triangle(south, index(rings - 1, s), index(rings - 1, s + 1));
+    }
+    return soup.build(out, threads);
+}
+
+bool generateTorus(int majorSegments, int minorSegments, float minorRadius, HalfEdgeMesh &out, int threads) {
+    majorSegments = std::max(majorSegments, 3);
+    minorSegments = std::max(minorSegments, 3);
+    if (!fits(4 * uint64_t(majorSegments) * uint64_t(minorSegments), out)) {
+        return false;
+    }
+    size_t faces = size_t(majorSegments) * size_t(minorSegments);
+    Soup soup(faces, faces, 4 * faces);
+    for (int i = 0; i < majorSegments; i++) {
+        float u = 2.0f * pi * float(i) / float(majorSegments);
+        for (int j = 0; j < minorSegments; j++) {
+            float v = 2.0f * pi * float(j) / float(minorSegments);
+            float radius = 1.0f + minorRadius * std::cos(v);
+            soup.positions.push_back(glm::vec3(radius * std::cos(u), minorRadius * std::sin(v), radius * std::sin(u)));
+        }
+    }
+    auto index = [majorSegments, minorSegments](int i, int j) {
+        return uint32_t((i % majorSegments) * minorSegments + j % minorSegments);
+    };
+    for (int i = 0; i < majorSegments; i++) {
+        for (int j = 0; j < minorSegments; j++) {
+            soup.quad(index(i, j), index(i, j + 1), index(i + 1, j + 1), index(i + 1, j));
+        }
+    }
+    return soup.build(out, threads);
+}
+
+bool generateCube(int n, HalfEdgeMesh &out, int threads) {
+    n = std::max(n, 1);
+    if (!fits(24 * uint64_t(n) * uint64_t(n), out)) {
+        return false;
+    }
+    size_t faces = 6 * size_t(n) * size_t(n);
+    Soup soup(faces + 2, faces, 4 * faces);
+
+    // every side is an (n + 1)^2 lattice spanned by u and v from its
+    // origin, with cross(u, v) pointing outward. Interior lattice points
+    // belong to one side; points on the cube's edges are shared and
+    // welded through a table keyed by their lattice coordinates.
+    struct Side
+    {
+        int origin[3];
+        int u[3];
+        int v[3];
+    };
+    const Side sides[6] = {
+        {{n, 0, 0}, {0, 1, 0}, {0, 0, 1}}, // +x
+        {{0, 0, 0}, {0, 0, 1}, {0, 1, 0}}, // -x
+        {{0, n, 0}, {0, 0, 1}, {1, 0, 0}}, // +y
+        {{0, 0, 0}, {1, 0, 0}, {0, 0, 1}}, // -y
+        {{0, 0, n}, {1, 0, 0}, {0, 1, 0}}, // +z
+        {{0, 0, 0}, {0, 1, 0}, {1, 0, 0}}  // -z
+    };
+    std::unordered_map<uint64_t, uint32_t> shared;
+    shared.reserve(12 * size_t(n) + 8);
+    std::vector<uint32_t> lattice(size_t(n + 1) * size_t(n + 1));
+    for (const Side &side : sides) {
+        for (int a = 0; a <= n; a++) {
+            for (int b = 0; b <= n; b++) {
+                int p[3];
+                int onBoundary = 0;
+                for (int k = 0; k < 3; k++) {
+                    p[k] = side.origin[k] + a * side.u[k] + b * side.v[k];
+                    onBoundary += p[k] == 0 || p[k] == n ? 1 : 0;
+                }
+                uint32_t next = uint32_t(soup.positions.size());
+                uint32_t index = next;
+                if (onBoundary >= 2) {
+                    uint64_t key = (uint64_t(p[0]) << 42) | (uint64_t(p[1]) << 21) | uint64_t(p[2]);
+                    index = shared.emplace(key, next).first->second;
+                }
+                if (index == next) {
+                    soup.positions.push_back(glm::vec3(float(p[0]) / n - 0.5f, float(p[1]) / n - 0.5f,
+                                                       float(p[2]) / n - 0.5f));
+                }
+                lattice[size_t(a) * (n + 1) + b] = index;
+            }
+        }
+        for (int a = 0; a < n; a++) {
+            for (int b = 0; b < n; b++) {
+                size_t i = size_t(a) * (n + 1) + b;
+                soup.quad(lattice[i], lattice[i + n + 1], lattice[i + n + 2], lattice[i + 1]);
+            }
+        }
+    }
+    return soup.build(out, threads);
+}
+
+bool generatePrism(int sides, HalfEdgeMesh &out, int threads) {
+    sides = std::max(sides, 3);
+    // two caps and a quad per side
+    if (!fits(6 * uint64_t(sides), out)) {
+        return false;
+    }
+    Soup soup(2 * size_t(sides), size_t(sides) + 2, 6 * size_t(sides));
+    // top ring first, then the bottom ring
+    for (int ring = 0; ring < 2; ring++) {
+        float y = ring == 0 ? 0.5f : -0.5f;
+        for (int s = 0; s < sides; s++) {
+            float phi = 2.0f * pi * float(s) / float(sides);
+            soup.positions.push_back(glm::vec3(std::cos(phi), y, std::sin(phi)));
+        }
+    }
+    uint32_t n = uint32_t(sides);
+    // the caps wind in opposite directions so both face outward
+    for (uint32_t s = 0; s < n; s++) {
+        soup.faceIndices.push_back(n - 1 - s);
+    }
+    soup.faceStart.push_back(uint32_t(soup.faceIndices.size()));
+    for (uint32_t s = 0; s < n; s++) {
+        soup.faceIndices.push_back(n + s);
+    }
+    soup.faceStart.push_back(uint32_t(soup.faceIndices.size()));
+    for (uint32_t s = 0; s < n; s++) {
+        uint32_t t = (s + 1) % n;
+        soup.quad(s, t, n + t, n + s);
+    }
+    return soup.build(out, threads);
+}
@@ -0,0 +1,26 @@
+#pragma once
+#include "halfedgemesh.h"
+
+// Procedural meshes for scaling and stress tests.
+// Each generator replaces the contents of out with a welded mesh whose
+// faces are counter-clockwise seen from outside, built through
+// buildHalfEdgeMesh so the result matches an imported OBJ. Resolutions
+// below the minimum are raised to it. A resolution whose mesh would
+// have more halfedges than a HalfEdgeMesh can count makes the generator
+// return false and leave out empty. threads <= 0 uses every core.
+
+// flat nx by nz grid of quads in the xz plane, facing +y; open boundary
+bool generateGrid(int nx, int nz, HalfEdgeMesh &out, int threads = 0);
+
+// unit sphere with rings - 2 quad bands and a triangle fan at each pole;
+// the poles have valence segments, so a large segment count gives high-valence poles
+bool generateUVSphere(int segments, int rings, HalfEdgeMesh &out, int threads = 0);
+
+// quad torus with major radius 1 and minor radius minorRadius
+bool generateTorus(int majorSegments, int minorSegments, float minorRadius, HalfEdgeMesh &out, int threads = 0);
+
+// unit cube with n by n quads on every side
+bool generateCube(int n, HalfEdgeMesh &out, int threads = 0);
+
+// prism whose top and bottom are single n-gons with sides corners, joined by quads
+bool generatePrism(int sides, HalfEdgeMesh &out, int threads = 0);
@@ -1,18 +1,48 @@
 #include "halfedge.h"
+#include "halfedgemesh.h"
 
 // constructor
 HalfEdge::HalfEdge()
-    : QListWidgetItem(), sym(nullptr)
-{
-    id = lastHalfEdge++;
-    this->setText(QString::number(this->id));
+    : mesh(nullptr), index(HalfEdgeMesh::NONE), generation(0)
+{}
+
+HalfEdge::HalfEdge(HalfEdgeMesh *mesh, uint32_t index)
+    : mesh(mesh), index(index), generation(mesh ? mesh->halfEdgeGeneration(index) : 0)
+{}
+
+HalfEdge HalfEdge::next() const {
+    return HalfEdge(mesh, mesh->heNext[index]);
+}
+
+HalfEdge HalfEdge::sym() const {
+    return HalfEdge(mesh, mesh->heSym[index]);
+}
+
+Face HalfEdge::face() const {
+    return Face(mesh, mesh->heFace[index]);
+}
+
+Vertex HalfEdge::vertex() const {
+    return Vertex(mesh, mesh->heVertex[index]);
 }
 
 // returns previous edge
-HalfEdge* HalfEdge::prevEdge() {
-    HalfEdge *curr = this;
-    do {
-        curr = curr->next;
-    } while (curr->next != this);
-    return curr;
+HalfEdge HalfEdge::prevEdge() const {
+    return HalfEdge(mesh, mesh->prevHalfEdge(index));
+}
+
+int HalfEdge::id() const {
+    return int(index);
+}
+
+bool HalfEdge::isValid() const {
+    return mesh != nullptr && mesh->isHalfEdgeAlive(index) && mesh->halfEdgeGeneration(index) == generation;
+}
+
+bool HalfEdge::operator==(const HalfEdge &other) const {
+    return mesh == other.mesh && index == other.index && generation == other.generation;
+}
+
+bool HalfEdge::operator!=(const HalfEdge &other) const {
+    return !(*this == other);
 }
@@ -1,24 +1,27 @@
 #pragma once
-#include "face.h"
-#include "vertex.h"
-#include <QListWidgetItem>
-
+#include <cstdint>
 
+class HalfEdgeMesh;
 class Face;
 class Vertex;
 
-static int lastHalfEdge;
-
-class HalfEdge : public QListWidgetItem
+// Lightweight view of a halfedge stored in a HalfEdgeMesh
+class HalfEdge
 {
 public:
-    HalfEdge();
-    HalfEdge *next; // next halfedge it points to
-    HalfEdge *sym; // symmetric halfedge
-    Face *face; // face that the edge is on
-    Vertex *vertex;
-    int id;
-    HalfEdge* prevEdge();
-
+    HalfEdge(); // invalid halfedge
+    HalfEdge(HalfEdgeMesh *mesh, uint32_t index);
+    HalfEdge next() const; // next halfedge it points to
+    HalfEdge sym() const; // symmetric halfedge, invalid on a boundary
+    Face face() const; // face that the edge is on
+    Vertex vertex() const; // vertex the edge points to
+    HalfEdge prevEdge() const; // previous halfedge in the face
+    int id() const; // unique id for halfedge
+    bool isValid() const; // false once the halfedge is removed, even if its slot is reused
+    bool operator==(const HalfEdge &other) const;
+    bool operator!=(const HalfEdge &other) const;
 
+    HalfEdgeMesh *mesh; // mesh that stores the halfedge
+    uint32_t index; // index of the halfedge in the mesh arrays
+    uint32_t generation; // generation of the slot when the view was made
 };
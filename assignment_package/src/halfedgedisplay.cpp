@@ -16,34 +16,25 @@ GLenum HalfEdgeDisplay::drawMode() {
 // representation of the currently selected Vertex
 void HalfEdgeDisplay::create() {
     std::vector<GLuint> idxVec;
-    std::vector<glm::vec4> posVec;
-    std::vector<glm::vec4> colorVec;
+    std::vector<PackedVertex> vertVec;
 
     // fill vectors with two endpoints
-    if (representedEdge != nullptr) {
+    if (representedEdge.isValid()) {
         idxVec.push_back(0);
         idxVec.push_back(1);
-        posVec.push_back(glm::vec4(this->representedEdge->vertex->pos, 1));
-        posVec.push_back(glm::vec4(this->representedEdge->sym->vertex->pos, 1));
-        colorVec.push_back(glm::vec4(1, 1, 0, 1));
-        colorVec.push_back(glm::vec4(1, 0, 0, 1));
+        vertVec.push_back(PackedVertex(this->representedEdge.vertex().pos(), glm::vec3(0), glm::vec3(1, 1, 0)));
+        vertVec.push_back(PackedVertex(this->representedEdge.prevEdge().vertex().pos(), glm::vec3(0), glm::vec3(1, 0, 0)));
     }
 
     count = idxVec.size();
     generateIdx();
-    bindIdx();
-    mp_context->glBufferData(GL_ELEMENT_ARRAY_BUFFER, idxVec.size() * sizeof(GLuint), idxVec.data(), GL_STATIC_DRAW);
+    uploadIdx(idxVec.size() * sizeof(GLuint), idxVec.data(), GL_STATIC_DRAW);
 
-    generatePos();
-    bindPos();
-    mp_context->glBufferData(GL_ARRAY_BUFFER, posVec.size() * sizeof(glm::vec4), posVec.data(), GL_STATIC_DRAW);
-
-    generateCol();
-    bindCol();
-    mp_context->glBufferData(GL_ARRAY_BUFFER, colorVec.size() * sizeof(glm::vec4), colorVec.data(), GL_STATIC_DRAW);
+    generateInterleaved();
+    uploadInterleaved(vertVec.size() * sizeof(PackedVertex), vertVec.data(), GL_STATIC_DRAW);
 }
 
 // updates the edge it represents
-void HalfEdgeDisplay::updateEdge(HalfEdge *edge) {
+void HalfEdgeDisplay::updateEdge(HalfEdge edge) {
     this->representedEdge = edge;
 }
@@ -1,18 +1,18 @@
 #pragma once
 #include "drawable.h"
-#include "halfedge.h"
+#include "halfedgemesh.h"
 #include <vector>
 
 class HalfEdgeDisplay : public Drawable
 {
 protected:
-    HalfEdge *representedEdge = nullptr;
+    HalfEdge representedEdge;
 
 public:
     HalfEdgeDisplay(OpenGLContext*);
     ~HalfEdgeDisplay();
     GLenum drawMode() override;
     virtual void create() override;
-    void updateEdge(HalfEdge*); // updates the edge it represents
+    void updateEdge(HalfEdge); // updates the edge it represents
 };
 
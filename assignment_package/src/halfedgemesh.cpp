@@ -0,0 +1,649 @@
+#include "halfedgemesh.h"
+#include "trace.h"
+#include <cstdlib>
+
+namespace {
+
+const uint32_t NONE = HalfEdgeMesh::NONE;
+
+inline uint32_t generationOf(const std::vector<uint32_t> &gen, uint32_t index) {
+    return index < gen.size() ? gen[index] : 0;
+}
+
+// a slot that is being filled moves past every generation handed out for it
+inline void reviveSlot(std::vector<uint32_t> &gen, uint32_t index) {
+    if (index < gen.size()) {
+        gen[index] = (gen[index] | 1) + 1;
+    }
+}
+
+// revives the slots of an appended range that a compact() left generations for
+inline void reviveRange(std::vector<uint32_t> &gen, uint32_t first, uint32_t count) {
+    for (uint32_t i = first; i < first + count && i < gen.size(); i++) {
+        reviveSlot(gen, i);
+    }
+}
+
+inline void freeSlot(std::vector<uint32_t> &gen, std::vector<uint32_t> &freeList, uint32_t index) {
+    if (index >= gen.size()) {
+        // slots filled directly after clear() have no entry yet
+        gen.resize(index + 1, 0);
+    }
+    gen[index] |= 1;
+    freeList.push_back(index);
+}
+
+// gives every live slot its index after compaction and returns the live count
+uint32_t numberSlots(const std::vector<uint32_t> &gen, size_t count, std::vector<uint32_t> &newIndex) {
+    newIndex.resize(count);
+    uint32_t next = 0;
+    for (size_t i = 0; i < count; i++) {
+        newIndex[i] = generationOf(gen, uint32_t(i)) & 1 ? NONE : next++;
+    }
+    return next;
+}
+
+// moves every live entry to its new index, entries only move down
+template<typename T>
+void moveSlots(std::vector<T> &data, const std::vector<uint32_t> &newIndex, uint32_t live) {
+    for (size_t i = 0; i < newIndex.size(); i++) {
+        if (newIndex[i] != NONE && newIndex[i] != i) {
+            data[newIndex[i]] = data[i];
+        }
+    }
+    data.resize(live);
+}
+
+// a slot that gets a different element, or none, must not accept views of
+// its old element. The array keeps its length so slots added later past
+// the live count still move on from these generations.
+void moveGenerations(std::vector<uint32_t> &gen, const std::vector<uint32_t> &newIndex, uint32_t live) {
+    if (gen.size() < newIndex.size()) {
+        gen.resize(newIndex.size(), 0);
+    }
+    for (size_t i = 0; i < newIndex.size(); i++) {
+        if (newIndex[i] != NONE && newIndex[i] != i) {
+            reviveSlot(gen, newIndex[i]);
+        }
+    }
+    for (size_t i = live; i < gen.size(); i++) {
+        gen[i] |= 1;
+    }
+}
+
+inline void remapLinks(std::vector<uint32_t> &links, const std::vector<uint32_t> &newIndex) {
+    for (uint32_t &link : links) {
+        link = link == NONE ? NONE : newIndex[link];
+    }
+}
+
+} // namespace
+
+HalfEdgeMesh::HalfEdgeMesh()
+{}
+
+HalfEdgeMesh::~HalfEdgeMesh()
+{}
+
+int HalfEdgeMesh::numVertices() const {
+    return int(vertPos.size());
+}
+
+int HalfEdgeMesh::numHalfEdges() const {
+    return int(heNext.size());
+}
+
+int HalfEdgeMesh::numFaces() const {
+    return int(faceHalfEdge.size());
+}
+
+uint32_t HalfEdgeMesh::vertexGeneration(uint32_t index) const {
+    return generationOf(vertGen, index);
+}
+
+uint32_t HalfEdgeMesh::halfEdgeGeneration(uint32_t index) const {
+    return generationOf(heGen, index);
+}
+
+uint32_t HalfEdgeMesh::faceGeneration(uint32_t index) const {
+    return generationOf(faceGen, index);
+}
+
+bool HalfEdgeMesh::isVertexAlive(uint32_t index) const {
+    return index < uint32_t(numVertices()) && (vertexGeneration(index) & 1) == 0;
+}
+
+bool HalfEdgeMesh::isHalfEdgeAlive(uint32_t index) const {
+    return index < uint32_t(numHalfEdges()) && (halfEdgeGeneration(index) & 1) == 0;
+}
+
+bool HalfEdgeMesh::isFaceAlive(uint32_t index) const {
+    return index < uint32_t(numFaces()) && (faceGeneration(index) & 1) == 0;
+}
+
+bool HalfEdgeMesh::isCompact() const {
+    return freeVertices.empty() && freeHalfEdges.empty() && freeFaces.empty() &&
+           detachedVertices.empty();
+}
+
+Vertex HalfEdgeMesh::vertex(uint32_t index) {
+    return Vertex(this, index);
+}
+
+HalfEdge HalfEdgeMesh::halfEdge(uint32_t index) {
+    return HalfEdge(this, index);
+}
+
+Face HalfEdgeMesh::face(uint32_t index) {
+    return Face(this, index);
+}
+
+uint32_t HalfEdgeMesh::addVertex(const glm::vec3 &pos) {
+    // copy first, pos may refer to an element of vertPos
+    glm::vec3 p = pos;
+    uint32_t v;
+    if (!freeVertices.empty()) {
+        v = freeVertices.back();
+        freeVertices.pop_back();
+        vertPos[v] = p;
+    } else {
+        v = uint32_t(vertPos.size());
+        vertPos.push_back(p);
+        vertHalfEdge.push_back(NONE);
+    }
+    reviveSlot(vertGen, v);
+    return v;
+}
+
+uint32_t HalfEdgeMesh::addHalfEdge() {
+    uint32_t he;
+    if (!freeHalfEdges.empty()) {
+        he = freeHalfEdges.back();
+        freeHalfEdges.pop_back();
+    } else {
+        he = uint32_t(heNext.size());
+        heNext.push_back(NONE);
+        heSym.push_back(NONE);
+        heVertex.push_back(NONE);
+        heFace.push_back(NONE);
+    }
+    reviveSlot(heGen, he);
+    return he;
+}
+
+uint32_t HalfEdgeMesh::addFace() {
+    return addFace(glm::vec3(float(rand())/float((RAND_MAX)),
+                             float(rand())/float((RAND_MAX)),
+                             float(rand())/float((RAND_MAX))));
+}
+
+uint32_t HalfEdgeMesh::addFace(const glm::vec3 &color) {
+    // copy first, color may refer to an element of faceColor
+    glm::vec3 c = color;
+    uint32_t f;
+    if (!freeFaces.empty()) {
+        f = freeFaces.back();
+        freeFaces.pop_back();
+        faceColor[f] = c;
+    } else {
+        f = uint32_t(faceHalfEdge.size());
+        faceHalfEdge.push_back(NONE);
+        faceColor.push_back(c);
+    }
+    reviveSlot(faceGen, f);
+    return f;
+}
+
+uint32_t HalfEdgeMesh::addVertices(uint32_t count) {
+    uint32_t first = uint32_t(vertPos.size());
+    vertPos.resize(first + count, glm::vec3(0));
+    vertHalfEdge.resize(first + count, NONE);
+    reviveRange(vertGen, first, count);
+    return first;
+}
+
+uint32_t HalfEdgeMesh::addHalfEdges(uint32_t count) {
+    uint32_t first = uint32_t(heNext.size());
+    heNext.resize(first + count, NONE);
+    heSym.resize(first + count, NONE);
+    heVertex.resize(first + count, NONE);
+    heFace.resize(first + count, NONE);
+    reviveRange(heGen, first, count);
+    return first;
+}
+
+uint32_t HalfEdgeMesh::addFaces(uint32_t count) {
+    uint32_t first = uint32_t(faceHalfEdge.size());
+    faceHalfEdge.resize(first + count, NONE);
+    faceColor.resize(first + count, glm::vec3(0));
+    reviveRange(faceGen, first, count);
+    return first;
+}
+
+void HalfEdgeMesh::removeVertex(uint32_t index) {
+    vertHalfEdge[index] = NONE;
+    freeSlot(vertGen, freeVertices, index);
+}
+
+void HalfEdgeMesh::removeHalfEdge(uint32_t index) {
+    heNext[index] = NONE;
+    heSym[index] = NONE;
+    heVertex[index] = NONE;
+    heFace[index] = NONE;
+    freeSlot(heGen, freeHalfEdges, index);
+}
+
+void HalfEdgeMesh::removeFace(uint32_t index) {
+    faceHalfEdge[index] = NONE;
+    freeSlot(faceGen, freeFaces, index);
+}
+
+void HalfEdgeMesh::compact(MeshRemap *remap) {
+    TRACE_SCOPE("HalfEdgeMesh::compact");
+    if (!detachedVertices.empty()) {
+        settleDetachedVertices();
+    }
+    MeshRemap local;
+    MeshRemap &map = remap ? *remap : local;
+    map.vertGen = vertGen;
+    map.heGen = heGen;
+    map.faceGen = faceGen;
+    uint32_t nVertices = numberSlots(vertGen, vertPos.size(), map.vertices);
+    uint32_t nHalfEdges = numberSlots(heGen, heNext.size(), map.halfEdges);
+    uint32_t nFaces = numberSlots(faceGen, faceHalfEdge.size(), map.faces);
+
+    remapLinks(heNext, map.halfEdges);
+    remapLinks(heSym, map.halfEdges);
+    remapLinks(heVertex, map.vertices);
+    remapLinks(heFace, map.faces);
+    remapLinks(vertHalfEdge, map.halfEdges);
+    remapLinks(faceHalfEdge, map.halfEdges);
+
+    moveSlots(heNext, map.halfEdges, nHalfEdges);
+    moveSlots(heSym, map.halfEdges, nHalfEdges);
+    moveSlots(heVertex, map.halfEdges, nHalfEdges);
+    moveSlots(heFace, map.halfEdges, nHalfEdges);
+    moveSlots(vertPos, map.vertices, nVertices);
+    moveSlots(vertHalfEdge, map.vertices, nVertices);
+    moveSlots(faceHalfEdge, map.faces, nFaces);
+    moveSlots(faceColor, map.faces, nFaces);
+
+    moveGenerations(vertGen, map.vertices, nVertices);
+    moveGenerations(heGen, map.halfEdges, nHalfEdges);
+    moveGenerations(faceGen, map.faces, nFaces);
+    freeVertices.clear();
+    freeHalfEdges.clear();
+    freeFaces.clear();
+}
+
+void HalfEdgeMesh::reserve(int vertices, int halfEdges, int faces) {
+    vertPos.reserve(vertices);
+    vertHalfEdge.reserve(vertices);
+    heNext.reserve(halfEdges);
+    heSym.reserve(halfEdges);
+    heVertex.reserve(halfEdges);
+    heFace.reserve(halfEdges);
+    faceHalfEdge.reserve(faces);
+    faceColor.reserve(faces);
+}
+
+void HalfEdgeMesh::clear() {
+    heNext.clear();
+    heSym.clear();
+    heVertex.clear();
+    heFace.clear();
+    vertPos.clear();
+    vertHalfEdge.clear();
+    faceHalfEdge.clear();
+    faceColor.clear();
+    vertGen.clear();
+    heGen.clear();
+    faceGen.clear();
+    freeVertices.clear();
+    freeHalfEdges.clear();
+    freeFaces.clear();
+    detachedVertices.clear();
+}
+
+void HalfEdgeMesh::swap(HalfEdgeMesh &other) {
+    heNext.swap(other.heNext);
+    heSym.swap(other.heSym);
+    heVertex.swap(other.heVertex);
+    heFace.swap(other.heFace);
+    vertPos.swap(other.vertPos);
+    vertHalfEdge.swap(other.vertHalfEdge);
+    faceHalfEdge.swap(other.faceHalfEdge);
+    faceColor.swap(other.faceColor);
+    vertGen.swap(other.vertGen);
+    heGen.swap(other.heGen);
+    faceGen.swap(other.faceGen);
+    freeVertices.swap(other.freeVertices);
+    freeHalfEdges.swap(other.freeHalfEdges);
+    freeFaces.swap(other.freeFaces);
+    detachedVertices.swap(other.detachedVertices);
+}
+
+// returns vertex count of face
+int HalfEdgeMesh::faceVertexCount(uint32_t face) const {
+    int count = 0;
+    uint32_t start = faceHalfEdge[face];
+    uint32_t curr = start;
+    do {
+        count += 1;
+        curr = heNext[curr];
+    } while (curr != start);
+    return count;
+}
+
+// returns previous edge
+uint32_t HalfEdgeMesh::prevHalfEdge(uint32_t he) const {
+    uint32_t curr = he;
+    while (heNext[curr] != he) {
+        curr = heNext[curr];
+    }
+    return curr;
+}
+
+// obtain normal from cross product of the first two edges
+glm::vec3 HalfEdgeMesh::faceNormal(uint32_t face) const {
+    uint32_t e0 = faceHalfEdge[face];
+    uint32_t e1 = heNext[e0];
+    uint32_t e2 = heNext[e1];
+    const glm::vec3 &p0 = vertPos[heVertex[e0]];
+    const glm::vec3 &p1 = vertPos[heVertex[e1]];
+    const glm::vec3 &p2 = vertPos[heVertex[e2]];
+    glm::vec3 vec1 = glm::normalize(p1 - p0);
+    glm::vec3 vec2 = glm::normalize(p2 - p1);
+    return glm::normalize(glm::cross(vec1, vec2));
+}
+
+bool HalfEdgeMesh::isBoundaryFace(uint32_t face) const {
+    uint32_t first = faceHalfEdge[face];
+    uint32_t he = first;
+    do {
+        if (heSym[he] == NONE) {
+            return true;
+        }
+        he = heNext[he];
+    } while (he != first);
+    return false;
+}
+
+// inserts a new vertex at pos on the edge of he, returns the new vertex
+uint32_t HalfEdgeMesh::splitEdge(uint32_t he, const glm::vec3 &pos) {
+    uint32_t h1 = he;
+    uint32_t h2 = heSym[he];
+    uint32_t v3 = addVertex(pos);
+
+    uint32_t e1 = addHalfEdge();
+    heFace[e1] = heFace[h1];
+    heNext[e1] = heNext[h1];
+    heNext[h1] = e1;
+    heVertex[e1] = heVertex[h1];
+    if (vertHalfEdge[heVertex[h1]] == h1) {
+        vertHalfEdge[heVertex[h1]] = e1;
+    }
+    heVertex[h1] = v3;
+    vertHalfEdge[v3] = h1;
+
+    if (h2 != NONE) {
+        uint32_t e2 = addHalfEdge();
+        heFace[e2] = heFace[h2];
+        heNext[e2] = heNext[h2];
+        heNext[h2] = e2;
+        heVertex[e2] = heVertex[h2];
+        if (vertHalfEdge[heVertex[h2]] == h2) {
+            vertHalfEdge[heVertex[h2]] = e2;
+        }
+        heVertex[h2] = v3;
+        heSym[e1] = h2;
+        heSym[h2] = e1;
+        heSym[e2] = h1;
+        heSym[h1] = e2;
+    }
+    return v3;
+}
+
+// fans a face into triangles, new faces keep the color of the face
+void HalfEdgeMesh::triangulateFace(uint32_t face) {
+    int count = faceVertexCount(face);
+    // keep triangulating until every parts are triangles
+    for (int i = 0; i < count - 3; i++) {
+        uint32_t edge = faceHalfEdge[face];
+        uint32_t edgeNext = heNext[edge];
+        uint32_t edgeNext2 = heNext[edgeNext];
+        uint32_t e1 = addHalfEdge();
+        uint32_t e2 = addHalfEdge();
+        uint32_t f2 = addFace(faceColor[face]);
+        heVertex[e1] = heVertex[edge];
+        heVertex[e2] = heVertex[edgeNext2];
+        heSym[e1] = e2;
+        heSym[e2] = e1;
+        heFace[e1] = f2;
+        heFace[edgeNext] = f2;
+        heFace[edgeNext2] = f2;
+        heFace[e2] = face;
+        faceHalfEdge[f2] = e1;
+        heNext[e2] = heNext[edgeNext2];
+        heNext[edgeNext2] = e1;
+        heNext[e1] = edgeNext;
+        heNext[edge] = e2;
+    }
+}
+
+// extrudes a face by one unit along its normal
+void HalfEdgeMesh::extrudeFace(uint32_t face) {
+    // the side faces are stitched to the sym of every edge
+    if (isBoundaryFace(face)) {
+        return;
+    }
+    int count = faceVertexCount(face);
+    std::vector<uint32_t> vertEdges;
+    std::vector<uint32_t> topEdges;
+    std::vector<uint32_t> vertices;
+    uint32_t curr = faceHalfEdge[face];
+    uint32_t startEdge = faceHalfEdge[face];
+    glm::vec3 normal = faceNormal(face);
+
+    // initialize new vertices and edges
+    for (int i = 0; i < count; i++) {
+        uint32_t v1 = addHalfEdge();
+        uint32_t v2 = addHalfEdge();
+        uint32_t top = addHalfEdge();
+        uint32_t v = addVertex(vertPos[heVertex[startEdge]] + normal);
+        startEdge = heNext[startEdge];
+        if (i != 0) {
+            heSym[v2] = vertEdges[vertEdges.size()-2];
+            heSym[vertEdges[vertEdges.size()-2]] = v2;
+        }
+        vertEdges.push_back(v1);
+        vertEdges.push_back(v2);
+        topEdges.push_back(top);
+        vertices.push_back(v);
+    }
+    heSym[vertEdges[1]] = vertEdges[vertEdges.size()-2];
+    heSym[vertEdges[vertEdges.size()-2]] = vertEdges[1];
+
+    // extrude each edge of the face
+    uint32_t startVertex = heVertex[heSym[curr]];
+    // the face loop itself is not relinked, so the previous halfedge of
+    // each step is the one before it
+    uint32_t prev = prevHalfEdge(curr);
+    for (int i = 0; i < count; i++) {
+        uint32_t HE1 = curr;
+        uint32_t HE2 = heSym[HE1];
+        uint32_t v1 = heVertex[HE1];
+        uint32_t v2 = heVertex[HE2];
+        uint32_t v3 = vertices[i];
+        uint32_t v4 = vertices[(i + count - 1) % count];
+        uint32_t HE1B = addHalfEdge();
+        uint32_t HE2B = topEdges[i];
+        uint32_t HE3 = vertEdges[i*2];
+        uint32_t HE4 = vertEdges[i*2+1];
+        uint32_t f = addFace();
+        heVertex[HE1] = v3;
+        heVertex[prev] = v4;
+        heSym[HE1B] = HE1;
+        heSym[HE2B] = HE2;
+        heSym[HE1] = HE1B;
+        heSym[HE2] = HE2B;
+        heVertex[HE1B] = v4;
+        if (i == count - 1) {
+            heVertex[HE2B] = startVertex;
+        } else {
+            heVertex[HE2B] = v1;
+        }
+        heFace[HE1B] = f;
+        heFace[HE2B] = f;
+        heFace[HE3] = f;
+        heFace[HE4] = f;
+        heVertex[HE3] = v3;
+        heVertex[HE4] = v2;
+        heNext[HE1B] = HE4;
+        heNext[HE4] = HE2B;
+        heNext[HE2B] = HE3;
+        heNext[HE3] = HE1B;
+        faceHalfEdge[f] = HE1B;
+        vertHalfEdge[v3] = HE1;
+        // the base vertex may have pointed at HE1, which now ends on the cap
+        vertHalfEdge[heVertex[HE2B]] = HE2B;
+        prev = curr;
+        curr = heNext[curr];
+    }
+}
+
+// gives each detached vertex any live halfedge that still points to it,
+// and removes the ones that lost their last face
+void HalfEdgeMesh::settleDetachedVertices() {
+    std::vector<char> detached(vertPos.size(), 0);
+    for (uint32_t v : detachedVertices) {
+        // a vertex can be detached twice, or reused by addVertex since
+        detached[v] = isVertexAlive(v) && vertHalfEdge[v] == NONE;
+    }
+    for (uint32_t h = 0; h < uint32_t(heVertex.size()); h++) {
+        uint32_t v = heVertex[h];
+        if (v != NONE && detached[v] && isHalfEdgeAlive(h)) {
+            vertHalfEdge[v] = h;
+            detached[v] = 0;
+        }
+    }
+    for (uint32_t v : detachedVertices) {
+        if (detached[v]) {
+            removeVertex(v);
+            detached[v] = 0;
+        }
+    }
+    detachedVertices.clear();
+}
+
+// removes a face and its halfedges; the edges it shared become boundary
+// edges of its neighbours. A corner that pointed into the face gets a
+// halfedge from the face across one of its two edges. When both are
+// boundary edges the vertex may still have faces elsewhere, around a
+// pinched vertex, which cannot be found locally: it is detached and
+// compact() either finds it a halfedge or removes it.
+void HalfEdgeMesh::deleteFace(uint32_t face) {
+    uint32_t first = faceHalfEdge[face];
+    uint32_t he = first;
+    do {
+        uint32_t v = heVertex[he];
+        if (vertHalfEdge[v] == he) {
+            uint32_t sym = heSym[he];
+            uint32_t symNext = heSym[heNext[he]];
+            if (sym != NONE) {
+                vertHalfEdge[v] = prevHalfEdge(sym);
+            } else if (symNext != NONE) {
+                vertHalfEdge[v] = symNext;
+            } else {
+                vertHalfEdge[v] = NONE;
+                detachedVertices.push_back(v);
+            }
+        }
+        he = heNext[he];
+    } while (he != first);
+
+    he = first;
+    do {
+        uint32_t next = heNext[he];
+        if (heSym[he] != NONE) {
+            heSym[heSym[he]] = NONE;
+        }
+        removeHalfEdge(he);
+        he = next;
+    } while (he != first);
+    removeFace(face);
+}
+
+// initializes cube structure
+void HalfEdgeMesh::createCube() {
+    // vertices b1-b4 on the bottom and t1-t4 on the top
+    const glm::vec3 corners[8] = {
+        glm::vec3(-0.5, -0.5, 0.5), glm::vec3(0.5, -0.5, 0.5),
+        glm::vec3(0.5, -0.5, -0.5), glm::vec3(-0.5, -0.5, -0.5),
+        glm::vec3(-0.5, 0.5, -0.5), glm::vec3(0.5, 0.5, -0.5),
+        glm::vec3(0.5, 0.5, 0.5), glm::vec3(-0.5, 0.5, 0.5)
+    };
+    // vertex loops of the bottom, top, left, right, front and back faces
+    const uint32_t loops[6][4] = {
+        {0, 3, 2, 1}, {4, 7, 6, 5}, {7, 4, 3, 0},
+        {1, 2, 5, 6}, {7, 0, 1, 6}, {3, 4, 5, 2}
+    };
+
+    // add* may hand out free slots, so remember the ids it returns
+    uint32_t verts[8];
+    uint32_t edges[24];
+    reserve(numVertices() + 8, numHalfEdges() + 24, numFaces() + 6);
+    for (int i = 0; i < 8; i++) {
+        verts[i] = addVertex(corners[i]);
+    }
+    for (int l = 0; l < 6; l++) {
+        uint32_t f = addFace();
+        uint32_t *loop = edges + 4 * l;
+        for (int i = 0; i < 4; i++) {
+            loop[i] = addHalfEdge();
+        }
+        for (int i = 0; i < 4; i++) {
+            uint32_t e = loop[i];
+            heNext[e] = loop[(i + 1) % 4];
+            heFace[e] = f;
+            heVertex[e] = verts[loops[l][i]];
+            vertHalfEdge[verts[loops[l][i]]] = e;
+        }
+        faceHalfEdge[f] = loop[0];
+    }
+
+    // pair each halfedge (a -> b) with the halfedge (b -> a)
+    for (uint32_t e : edges) {
+        uint32_t from = heVertex[prevHalfEdge(e)];
+        for (uint32_t o : edges) {
+            if (heVertex[o] == from && heVertex[prevHalfEdge(o)] == heVertex[e]) {
+                heSym[e] = o;
+                break;
+            }
+        }
+    }
+}
+
+Vertex MeshRemap::apply(const Vertex &v) const {
+    if (v.index >= vertices.size() || vertices[v.index] == HalfEdgeMesh::NONE ||
+        generationOf(vertGen, v.index) != v.generation) {
+        return Vertex();
+    }
+    return v.mesh->vertex(vertices[v.index]);
+}
+
+HalfEdge MeshRemap::apply(const HalfEdge &he) const {
+    if (he.index >= halfEdges.size() || halfEdges[he.index] == HalfEdgeMesh::NONE ||
+        generationOf(heGen, he.index) != he.generation) {
+        return HalfEdge();
+    }
+    return he.mesh->halfEdge(halfEdges[he.index]);
+}
+
+Face MeshRemap::apply(const Face &f) const {
+    if (f.index >= faces.size() || faces[f.index] == HalfEdgeMesh::NONE ||
+        generationOf(faceGen, f.index) != f.generation) {
+        return Face();
+    }
+    return f.mesh->face(faces[f.index]);
+}
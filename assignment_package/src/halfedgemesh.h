@@ -0,0 +1,145 @@
+#pragma once
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <vector>
+#include "vertex.h"
+#include "halfedge.h"
+#include "face.h"
+
+// Index-based half-edge kernel.
+// Connectivity is stored as contiguous arrays of 32-bit indices
+// (one entry per element) instead of individually allocated objects,
+// so traversals walk through packed memory. The element id of a
+// vertex, halfedge or face is its index in these arrays.
+// Vertex, HalfEdge and Face are thin views into this structure.
+//
+// Removing an element only marks its slot as free, so deletions are
+// O(1) and leave every other id alone; add* fills free slots before
+// growing the arrays. Each slot carries a generation that is even while
+// the slot is in use and grows every time the slot is freed or reused,
+// and a view remembers the generation it was made with, so a view of a
+// removed element stops being valid instead of pointing at whatever
+// took its place. compact() closes the gaps in one linear pass.
+//
+// Ids are only meaningful within one mesh. add* hands out one id at a
+// time; builders that know their element counts reserve whole ranges
+// with addVertices, addHalfEdges and addFaces and fill them in parallel.
+class MeshRemap;
+
+class HalfEdgeMesh
+{
+public:
+    static constexpr uint32_t NONE = 0xFFFFFFFFu; // marks a missing link, e.g. sym on a boundary
+
+    HalfEdgeMesh();
+    virtual ~HalfEdgeMesh();
+
+    // per halfedge connectivity (16 bytes per halfedge)
+    std::vector<uint32_t> heNext; // next halfedge in the face loop
+    std::vector<uint32_t> heSym; // symmetric halfedge, NONE on a boundary
+    std::vector<uint32_t> heVertex; // vertex the halfedge points to
+    std::vector<uint32_t> heFace; // face that the halfedge is on
+
+    // per vertex data
+    std::vector<glm::vec3> vertPos; // vertex positions
+    std::vector<uint32_t> vertHalfEdge; // a halfedge that points to the vertex
+
+    // per face data
+    std::vector<uint32_t> faceHalfEdge; // any halfedge in the face
+    std::vector<glm::vec3> faceColor; // face colors
+
+    // generation of every slot, odd once the slot is freed. Slots past
+    // the end of these arrays are generation 0, so code that fills the
+    // element arrays directly after clear() does not have to touch them.
+    std::vector<uint32_t> vertGen;
+    std::vector<uint32_t> heGen;
+    std::vector<uint32_t> faceGen;
+
+    // slots freed by remove*, reused last in first out
+    std::vector<uint32_t> freeVertices;
+    std::vector<uint32_t> freeHalfEdges;
+    std::vector<uint32_t> freeFaces;
+    std::vector<uint32_t> detachedVertices; // vertices deleteFace left without a halfedge, settled by compact()
+
+    // slot counts, including free slots until compact()
+    int numVertices() const;
+    int numHalfEdges() const;
+    int numFaces() const;
+
+    uint32_t vertexGeneration(uint32_t index) const;
+    uint32_t halfEdgeGeneration(uint32_t index) const;
+    uint32_t faceGeneration(uint32_t index) const;
+    bool isVertexAlive(uint32_t index) const; // index is in range and its slot is in use
+    bool isHalfEdgeAlive(uint32_t index) const;
+    bool isFaceAlive(uint32_t index) const;
+    bool isCompact() const; // no free slots and nothing for compact() to do
+
+    // views of single elements
+    Vertex vertex(uint32_t index);
+    HalfEdge halfEdge(uint32_t index);
+    Face face(uint32_t index);
+
+    // adds an element in a free slot or at the end and returns its index; links are set to NONE
+    uint32_t addVertex(const glm::vec3 &pos);
+    uint32_t addHalfEdge();
+    uint32_t addFace(); // random color
+    uint32_t addFace(const glm::vec3 &color);
+
+    // appends count elements with consecutive ids and returns the first.
+    // Free slots are skipped so the range is contiguous, and once it is
+    // reserved any number of threads can fill disjoint parts of it
+    // without sharing a counter. Links are NONE, positions and colors zero.
+    uint32_t addVertices(uint32_t count);
+    uint32_t addHalfEdges(uint32_t count);
+    uint32_t addFaces(uint32_t count);
+
+    // frees the slot of a live element in O(1) and sets its links to NONE;
+    // links from other elements to it are left for the caller to fix
+    void removeVertex(uint32_t index);
+    void removeHalfEdge(uint32_t index);
+    void removeFace(uint32_t index);
+
+    // moves the live elements down over the free slots, keeping their
+    // order, and rewrites every link; links to removed elements become
+    // NONE. Detached vertices that no halfedge points to any more are
+    // removed first. Linear in the slot count. Subdivision, the draw
+    // buffers and the writers walk every slot, so they expect a compact mesh.
+    void compact(MeshRemap *remap = nullptr);
+
+    void reserve(int vertices, int halfEdges, int faces);
+    void clear(); // removes every element, views made before are not tracked across it
+    void swap(HalfEdgeMesh &other); // exchanges the elements of two meshes
+
+    int faceVertexCount(uint32_t face) const; // number of vertices of a face
+    uint32_t prevHalfEdge(uint32_t he) const; // previous halfedge in the face loop
+    glm::vec3 faceNormal(uint32_t face) const; // normal from the first corner of the face
+    bool isBoundaryFace(uint32_t face) const; // some edge of the face has no sym
+
+    // topology editing operators
+    uint32_t splitEdge(uint32_t he, const glm::vec3 &pos); // inserts a vertex on an edge, returns it
+    void triangulateFace(uint32_t face); // fans a face into triangles
+    void extrudeFace(uint32_t face); // extrudes a face along its normal, boundary faces are left as they are
+    void deleteFace(uint32_t face); // removes a face and its halfedges
+
+    void createCube(); // initializes cube structure
+
+private:
+    void settleDetachedVertices(); // first step of compact()
+};
+
+// where compact() moved the elements, for updating views made before it
+class MeshRemap
+{
+public:
+    std::vector<uint32_t> vertices; // new index of every old vertex slot, NONE if it was free
+    std::vector<uint32_t> halfEdges;
+    std::vector<uint32_t> faces;
+    std::vector<uint32_t> vertGen; // generation of every old slot, to reject stale views
+    std::vector<uint32_t> heGen;
+    std::vector<uint32_t> faceGen;
+
+    // the same element after compact(), invalid if it was removed or v was already stale
+    Vertex apply(const Vertex &v) const;
+    HalfEdge apply(const HalfEdge &he) const;
+    Face apply(const Face &f) const;
+};
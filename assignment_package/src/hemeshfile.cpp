@@ -0,0 +1,241 @@
+#include "hemeshfile.h"
+#include "mappedfile.h"
+#include "parallel.h"
+#include <cstdio>
+#include <cstring>
+
+namespace {
+
+const char magic[8] = {'H', 'E', 'M', 'E', 'S', 'H', 0, 0};
+const uint32_t byteOrderTag = 0x01020304u;
+const uint64_t alignment = 64;
+
+// array order in the offset table
+enum Section
+{
+    SECTION_HE_NEXT = 0,
+    SECTION_HE_SYM,
+    SECTION_HE_VERTEX,
+    SECTION_HE_FACE,
+    SECTION_VERT_POS,
+    SECTION_VERT_HALF_EDGE,
+    SECTION_FACE_HALF_EDGE,
+    SECTION_FACE_COLOR,
+    SECTION_COUNT
+};
+
+struct Header
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t byteOrder;
+    uint32_t numVertices;
+    uint32_t numHalfEdges;
+    uint32_t numFaces;
+    uint32_t reserved;
+    uint64_t offsets[SECTION_COUNT];
+};
+static_assert(sizeof(Header) == 96, "hemesh header must stay 96 bytes");
+static_assert(sizeof(glm::vec3) == 12, "vertPos and faceColor are stored as packed floats");
+
+inline uint64_t alignUp(uint64_t offset) {
+    return (offset + alignment - 1) / alignment * alignment;
+}
+
+// bytes of every array for the given element counts
+void sectionSizes(uint64_t nVertices, uint64_t nHalfEdges, uint64_t nFaces, uint64_t *sizes) {
+    sizes[SECTION_HE_NEXT] = nHalfEdges * sizeof(uint32_t);
+    sizes[SECTION_HE_SYM] = nHalfEdges * sizeof(uint32_t);
+    sizes[SECTION_HE_VERTEX] = nHalfEdges * sizeof(uint32_t);
+    sizes[SECTION_HE_FACE] = nHalfEdges * sizeof(uint32_t);
+    sizes[SECTION_VERT_POS] = nVertices * sizeof(glm::vec3);
+    sizes[SECTION_VERT_HALF_EDGE] = nVertices * sizeof(uint32_t);
+    sizes[SECTION_FACE_HALF_EDGE] = nFaces * sizeof(uint32_t);
+    sizes[SECTION_FACE_COLOR] = nFaces * sizeof(glm::vec3);
+}
+
+template<typename T>
+void copySection(const char *data, uint64_t offset, size_t count, std::vector<T> &out) {
+    const T *begin = reinterpret_cast<const T*>(data + offset);
+    out.assign(begin, begin + count);
+}
+
+} // namespace
+
+HemeshFile::HemeshFile(int threads)
+    : threads(threads), message()
+{}
+
+void HemeshFile::setThreads(int threads) {
+    this->threads = threads;
+}
+
+const std::string &HemeshFile::error() const {
+    return message;
+}
+
+bool HemeshFile::write(const std::string &path, const HalfEdgeMesh &mesh) {
+    message.clear();
+    Header header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, magic, sizeof(magic));
+    header.version = HEMESH_VERSION;
+    header.byteOrder = byteOrderTag;
+    header.numVertices = uint32_t(mesh.numVertices());
+    header.numHalfEdges = uint32_t(mesh.numHalfEdges());
+    header.numFaces = uint32_t(mesh.numFaces());
+
+    uint64_t sizes[SECTION_COUNT];
+    sectionSizes(header.numVertices, header.numHalfEdges, header.numFaces, sizes);
+    uint64_t offset = sizeof(Header);
+    for (int s = 0; s < SECTION_COUNT; s++) {
+        header.offsets[s] = alignUp(offset);
+        offset = header.offsets[s] + sizes[s];
+    }
+    const void *arrays[SECTION_COUNT] = {
+        mesh.heNext.data(), mesh.heSym.data(), mesh.heVertex.data(), mesh.heFace.data(),
+        mesh.vertPos.data(), mesh.vertHalfEdge.data(), mesh.faceHalfEdge.data(), mesh.faceColor.data()
+    };
+
+    FILE *file = std::fopen(path.c_str(), "wb");
+    if (!file) {
+        message = "cannot open " + path;
+        return false;
+    }
+    const char padding[alignment] = {};
+    bool ok = std::fwrite(&header, sizeof(header), 1, file) == 1;
+    offset = sizeof(Header);
+    for (int s = 0; s < SECTION_COUNT && ok; s++) {
+        size_t pad = size_t(header.offsets[s] - offset);
+        ok = (pad == 0 || std::fwrite(padding, 1, pad, file) == pad)
+                && (sizes[s] == 0 || std::fwrite(arrays[s], 1, size_t(sizes[s]), file) == sizes[s]);
+        offset = header.offsets[s] + sizes[s];
+    }
+    ok = std::fclose(file) == 0 && ok;
+    if (!ok) {
+        message = "cannot write " + path;
+    }
+    return ok;
+}
+
+bool HemeshFile::read(const std::string &path, HalfEdgeMesh &out) {
+    out.clear();
+    message.clear();
+    MappedFile file;
+    if (!file.open(path)) {
+        message = "cannot open " + path;
+        return false;
+    }
+    const char *data = file.data();
+    uint64_t size = file.size();
+    Header header;
+    if (size < sizeof(Header)) {
+        message = "not a .hemesh file";
+        return false;
+    }
+    std::memcpy(&header, data, sizeof(header));
+    if (std::memcmp(header.magic, magic, sizeof(magic)) != 0) {
+        message = "not a .hemesh file";
+        return false;
+    }
+    if (header.byteOrder != byteOrderTag) {
+        message = "file was written with a different byte order";
+        return false;
+    }
+    if (header.version != HEMESH_VERSION) {
+        message = "unsupported .hemesh version " + std::to_string(header.version);
+        return false;
+    }
+
+    uint64_t sizes[SECTION_COUNT];
+    sectionSizes(header.numVertices, header.numHalfEdges, header.numFaces, sizes);
+    for (int s = 0; s < SECTION_COUNT; s++) {
+        uint64_t offset = header.offsets[s];
+        if (offset % alignment != 0 || offset > size || sizes[s] > size - offset) {
+            message = "truncated or corrupt .hemesh file";
+            return false;
+        }
+    }
+
+    // the mapping is page aligned and every array is on a 64-byte boundary
+    copySection(data, header.offsets[SECTION_HE_NEXT], header.numHalfEdges, out.heNext);
+    copySection(data, header.offsets[SECTION_HE_SYM], header.numHalfEdges, out.heSym);
+    copySection(data, header.offsets[SECTION_HE_VERTEX], header.numHalfEdges, out.heVertex);
+    copySection(data, header.offsets[SECTION_HE_FACE], header.numHalfEdges, out.heFace);
+    copySection(data, header.offsets[SECTION_VERT_POS], header.numVertices, out.vertPos);
+    copySection(data, header.offsets[SECTION_VERT_HALF_EDGE], header.numVertices, out.vertHalfEdge);
+    copySection(data, header.offsets[SECTION_FACE_HALF_EDGE], header.numFaces, out.faceHalfEdge);
+    copySection(data, header.offsets[SECTION_FACE_COLOR], header.numFaces, out.faceColor);
+
+    if (!validate(out)) {
+        out.clear();
+        message = "invalid connectivity in .hemesh file";
+        return false;
+    }
+    return true;
+}
+
+bool HemeshFile::validate(const HalfEdgeMesh &mesh) {
+    const uint32_t NONE = HalfEdgeMesh::NONE;
+    uint32_t nVertices = uint32_t(mesh.numVertices());
+    uint32_t nHalfEdges = uint32_t(mesh.numHalfEdges());
+    uint32_t nFaces = uint32_t(mesh.numFaces());
+
+    // every link in range, sym is an involution and next stays in the face
+    bool linksValid = parallelReduce(int(nHalfEdges), threads, true, [&](int begin, int end) {
+        for (int h = begin; h < end; h++) {
+            uint32_t next = mesh.heNext[h];
+            uint32_t sym = mesh.heSym[h];
+            bool ok = next < nHalfEdges && mesh.heVertex[h] < nVertices && mesh.heFace[h] < nFaces
+                    && mesh.heFace[next] == mesh.heFace[h];
+            if (ok && sym != NONE) {
+                ok = sym < nHalfEdges && sym != uint32_t(h) && mesh.heSym[sym] == uint32_t(h)
+                        && mesh.heVertex[sym] != mesh.heVertex[h];
+            }
+            if (!ok) {
+                return false;
+            }
+        }
+        return true;
+    }, [](bool a, bool b) {
+        return a && b;
+    });
+    if (!linksValid) {
+        return false;
+    }
+    for (uint32_t v = 0; v < nVertices; v++) {
+        uint32_t he = mesh.vertHalfEdge[v];
+        if (he != NONE && (he >= nHalfEdges || mesh.heVertex[he] != v)) {
+            return false;
+        }
+    }
+
+    // next is a permutation, so every face loop is a closed cycle
+    std::vector<uint32_t> faceSize(nFaces, 0);
+    std::vector<char> hasPrev(nHalfEdges, 0);
+    for (uint32_t h = 0; h < nHalfEdges; h++) {
+        uint32_t next = mesh.heNext[h];
+        if (hasPrev[next]) {
+            return false;
+        }
+        hasPrev[next] = 1;
+        faceSize[mesh.heFace[h]] += 1;
+    }
+    // and each face is a single cycle through faceHalfEdge
+    for (uint32_t f = 0; f < nFaces; f++) {
+        uint32_t first = mesh.faceHalfEdge[f];
+        if (first >= nHalfEdges || mesh.heFace[first] != f) {
+            return false;
+        }
+        uint32_t count = 0;
+        uint32_t he = first;
+        do {
+            count += 1;
+            he = mesh.heNext[he];
+        } while (he != first);
+        if (count != faceSize[f]) {
+            return false;
+        }
+    }
+    return true;
+}
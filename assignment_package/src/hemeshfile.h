@@ -0,0 +1,46 @@
+#pragma once
+#include "halfedgemesh.h"
+#include <string>
+
+// Native binary mesh format (.hemesh).
+// The file holds the HalfEdgeMesh arrays exactly as they are in memory,
+// so element ids survive a save and load. Layout, all little-endian:
+//
+//   header (96 bytes)
+//     char     magic[8]       "HEMESH\0\0"
+//     uint32_t version        HEMESH_VERSION
+//     uint32_t byteOrder      0x01020304 as written by the saving machine
+//     uint32_t numVertices
+//     uint32_t numHalfEdges
+//     uint32_t numFaces
+//     uint32_t reserved       0
+//     uint64_t offsets[8]     file offset of every array below
+//   arrays, each starting on a 64-byte boundary
+//     heNext, heSym, heVertex, heFace    uint32_t per halfedge
+//     vertPos                            3 floats per vertex
+//     vertHalfEdge                       uint32_t per vertex
+//     faceHalfEdge                       uint32_t per face
+//     faceColor                          3 floats per face
+//
+// Loading maps the file and copies each array with one memcpy; the
+// connectivity is then validated instead of rebuilt.
+class HemeshFile
+{
+public:
+    static constexpr uint32_t HEMESH_VERSION = 1;
+
+    // threads <= 0 uses every core, 1 validates serially
+    HemeshFile(int threads = 0);
+    void setThreads(int threads);
+
+    bool read(const std::string &path, HalfEdgeMesh &out); // false on failure, see error()
+    bool write(const std::string &path, const HalfEdgeMesh &mesh);
+
+    const std::string &error() const; // what went wrong in the last read or write
+
+private:
+    int threads; // requested thread count
+    std::string message; // last error
+
+    bool validate(const HalfEdgeMesh &mesh); // checks that every link is in range and consistent
+};
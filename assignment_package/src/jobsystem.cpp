@@ -0,0 +1,292 @@
+#include "jobsystem.h"
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+namespace {
+
+struct Task
+{
+    JobSystem::TaskFn fn;
+    void *context;
+    int index;
+    JobSystem::Group *group;
+};
+
+struct TaskQueue
+{
+    std::mutex mutex;
+    std::deque<Task> tasks;
+};
+
+class Pool
+{
+public:
+    explicit Pool(int workers);
+    ~Pool();
+
+    void push(int worker, const Task *tasks, int count);
+    bool pop(int worker, Task &task); // own tasks first, then shared, then stolen
+    void run(const Task &task);
+    void wait(int worker, JobSystem::Group &group); // runs tasks until group is done, sleeps when there are none
+
+    int numWorkers() const {
+        return int(threads.size());
+    }
+
+private:
+    std::vector<std::thread> threads;
+    std::vector<std::unique_ptr<TaskQueue>> queues; // one per worker
+    TaskQueue shared; // tasks from threads outside the pool
+    std::atomic<int> queued; // tasks in any queue
+    std::mutex sleepMutex;
+    std::condition_variable wake;
+    bool stopping;
+
+    void work(int worker);
+    bool take(TaskQueue &queue, bool back, Task &task);
+};
+
+thread_local int currentWorker = -1;
+
+std::mutex poolMutex; // guards pool creation and setThreads
+std::atomic<Pool*> pool(nullptr);
+int requestedThreads = 0;
+
+// number of threads to use for a requested count, <= 0 means every core
+int resolve(int threads) {
+    if (threads > 0) {
+        return threads;
+    }
+    int hw = int(std::thread::hardware_concurrency());
+    return hw > 0 ? hw : 1;
+}
+
+// the thread that waits runs tasks too, so the pool has one thread less
+Pool &getPool() {
+    Pool *p = pool.load(std::memory_order_acquire);
+    if (!p) {
+        std::lock_guard<std::mutex> lock(poolMutex);
+        p = pool.load(std::memory_order_relaxed);
+        if (!p) {
+            p = new Pool(resolve(requestedThreads) - 1);
+            pool.store(p, std::memory_order_release);
+        }
+    }
+    return *p;
+}
+
+// joins the workers at exit, before the statics they use go away
+struct PoolOwner
+{
+    ~PoolOwner() {
+        delete pool.exchange(nullptr);
+    }
+} poolOwner;
+
+Pool::Pool(int workers)
+    : threads(), queues(), shared(), queued(0), sleepMutex(), wake(), stopping(false)
+{
+    for (int w = 0; w < workers; w++) {
+        queues.emplace_back(new TaskQueue());
+    }
+    for (int w = 0; w < workers; w++) {
+        threads.emplace_back(&Pool::work, this, w);
+    }
+}
+
+Pool::~Pool() {
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (std::thread &thread : threads) {
+        thread.join();
+    }
+}
+
+void Pool::push(int worker, const Task *tasks, int count) {
+    TaskQueue &queue = worker >= 0 ? *queues[worker] : shared;
+    {
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.tasks.insert(queue.tasks.end(), tasks, tasks + count);
+    }
+    queued.fetch_add(count, std::memory_order_release);
+    // taking the lock orders this with a worker that is about to sleep
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+    }
+    if (count > 1) {
+        wake.notify_all();
+    } else {
+        wake.notify_one();
+    }
+}
+
+bool Pool::take(TaskQueue &queue, bool back, Task &task) {
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (queue.tasks.empty()) {
+        return false;
+    }
+    if (back) {
+        task = queue.tasks.back();
+        queue.tasks.pop_back();
+    } else {
+        task = queue.tasks.front();
+        queue.tasks.pop_front();
+    }
+    queued.fetch_sub(1, std::memory_order_relaxed);
+    return true;
+}
+
+bool Pool::pop(int worker, Task &task) {
+    if (queued.load(std::memory_order_acquire) == 0) {
+        return false;
+    }
+    if (worker >= 0 && take(*queues[worker], true, task)) {
+        return true;
+    }
+    if (take(shared, false, task)) {
+        return true;
+    }
+    // steal the oldest task, the largest piece of work, starting at the next worker
+    int n = numWorkers();
+    for (int i = 1; i <= n; i++) {
+        int victim = (worker + i + n) % n;
+        if (victim != worker && take(*queues[victim], false, task)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void Pool::run(const Task &task) {
+    task.fn(task.context, task.index);
+    if (task.group->pending.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        // the group is done, wake whoever sleeps in wait() for it; the
+        // group may be gone once the count is 0, so only the pool is used
+        {
+            std::lock_guard<std::mutex> lock(sleepMutex);
+        }
+        wake.notify_all();
+    }
+}
+
+void Pool::wait(int worker, JobSystem::Group &group) {
+    Task task;
+    while (group.pending.load(std::memory_order_acquire) > 0) {
+        if (pop(worker, task)) {
+            run(task);
+            continue;
+        }
+        // the remaining tasks run elsewhere, sleep until one of them ends
+        // the group or new tasks come in
+        std::unique_lock<std::mutex> lock(sleepMutex);
+        wake.wait(lock, [this, &group]() {
+            return group.pending.load(std::memory_order_acquire) == 0 ||
+                   queued.load(std::memory_order_acquire) > 0;
+        });
+    }
+}
+
+void Pool::work(int worker) {
+    currentWorker = worker;
+    Task task;
+    while (true) {
+        if (pop(worker, task)) {
+            run(task);
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(sleepMutex);
+        wake.wait(lock, [this]() {
+            return stopping || queued.load(std::memory_order_acquire) > 0;
+        });
+        if (stopping) {
+            return;
+        }
+    }
+}
+
+} // namespace
+
+void JobSystem::setThreads(int threads) {
+    std::lock_guard<std::mutex> lock(poolMutex);
+    requestedThreads = threads;
+    // the next parallel call starts a pool of the new size
+    delete pool.exchange(nullptr);
+}
+
+int JobSystem::threads() {
+    return getPool().numWorkers() + 1;
+}
+
+int JobSystem::workerIndex() {
+    return currentWorker;
+}
+
+void JobSystem::submit(Group &group, TaskFn fn, void *context, int begin, int end) {
+    if (begin >= end) {
+        return;
+    }
+    std::vector<Task> tasks;
+    tasks.reserve(end - begin);
+    for (int i = begin; i < end; i++) {
+        tasks.push_back(Task{fn, context, i, &group});
+    }
+    Pool &p = getPool();
+    if (p.numWorkers() == 0) {
+        // nobody to hand the tasks to, the waiting thread runs them
+        for (const Task &task : tasks) {
+            p.run(task);
+        }
+        return;
+    }
+    p.push(currentWorker, tasks.data(), int(tasks.size()));
+}
+
+void JobSystem::wait(Group &group) {
+    getPool().wait(currentWorker, group);
+}
+
+TaskGraph::TaskGraph()
+    : nodes(), waiting(), group()
+{}
+
+int TaskGraph::add(std::function<void()> fn) {
+    nodes.push_back(Node{std::move(fn), std::vector<int>(), 0});
+    return int(nodes.size() - 1);
+}
+
+void TaskGraph::precede(int before, int after) {
+    nodes[before].successors.push_back(after);
+    nodes[after].predecessors += 1;
+}
+
+void TaskGraph::run() {
+    int n = int(nodes.size());
+    waiting.reset(new std::atomic<int>[n]);
+    for (int i = 0; i < n; i++) {
+        waiting[i].store(nodes[i].predecessors, std::memory_order_relaxed);
+    }
+    group.pending.store(n, std::memory_order_relaxed);
+    for (int i = 0; i < n; i++) {
+        if (nodes[i].predecessors == 0) {
+            JobSystem::submit(group, &TaskGraph::runNode, this, i, i + 1);
+        }
+    }
+    JobSystem::wait(group);
+}
+
+// successors are queued before the node counts as finished, so the
+// group cannot run empty while nodes are still to come
+void TaskGraph::runNode(void *graph, int node) {
+    TaskGraph &g = *static_cast<TaskGraph*>(graph);
+    g.nodes[node].fn();
+    for (int next : g.nodes[node].successors) {
+        if (g.waiting[next].fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            JobSystem::submit(g.group, &TaskGraph::runNode, graph, next, next + 1);
+        }
+    }
+}
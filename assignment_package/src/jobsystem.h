@@ -0,0 +1,70 @@
+#pragma once
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <vector>
+
+// Work-stealing pool shared by every parallel loop and task graph.
+// The workers are started on first use and kept until exit, so a
+// parallel call costs a few queue operations instead of spawning
+// threads. Every worker has its own deque: it pushes and pops its own
+// tasks at the back while idle workers steal from the front, so nested
+// loops and task graphs spread over every core. Tasks from other
+// threads, such as the GUI thread, go to a shared queue.
+//
+// A thread waiting for its tasks runs queued tasks in the meantime, so
+// waiting from inside a task never blocks the pool; once there is nothing
+// left to take it sleeps until its tasks are done. Idle workers sleep as
+// well. Tasks must not throw.
+//
+// Tasks stay on the worker that took them, so ScratchScope (arena.h)
+// on a worker uses that worker's own arena, which now lives as long as
+// the pool and is reused from job to job.
+class JobSystem
+{
+public:
+    typedef void (*TaskFn)(void *context, int index);
+
+    // unfinished tasks of one parallel call
+    struct Group
+    {
+        std::atomic<int> pending{0};
+    };
+
+    // threads that run tasks, including the one that waits; <= 0 uses
+    // every core. Restarts the pool, so call it while nothing is running.
+    static void setThreads(int threads);
+    static int threads();
+    static int workerIndex(); // 0 .. threads() - 2 on a pool thread, -1 elsewhere
+
+    // queues fn(context, i) for every i in [begin, end); group.pending
+    // must already count them and each task takes one off when it ends
+    static void submit(Group &group, TaskFn fn, void *context, int begin, int end);
+    static void wait(Group &group); // returns once group.pending is 0, running tasks until then
+};
+
+// Tasks with dependencies, run on the JobSystem. Nodes whose
+// predecessors have finished run in parallel; the graph must be acyclic.
+class TaskGraph
+{
+public:
+    TaskGraph();
+
+    int add(std::function<void()> fn); // returns the node id
+    void precede(int before, int after); // after starts once before has finished
+    void run(); // runs every node once and returns when all have finished
+
+private:
+    struct Node
+    {
+        std::function<void()> fn;
+        std::vector<int> successors;
+        int predecessors;
+    };
+
+    std::vector<Node> nodes;
+    std::unique_ptr<std::atomic<int>[]> waiting; // unfinished predecessors of every node during run()
+    JobSystem::Group group;
+
+    static void runNode(void *graph, int node);
+};
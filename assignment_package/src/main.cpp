@@ -1,4 +1,5 @@
 #include <mainwindow.h>
+#include "trace.h"
 
 #include <QApplication>
 #include <QSurfaceFormat>
@@ -24,9 +25,10 @@ int main(int argc, char *argv[])
     QApplication::setAttribute(Qt::AA_EnableHighDpiScaling);
     QApplication a(argc, argv);
 
-    // Set OpenGL 3.2 and, optionally, 4-sample multisampling
+    // Set OpenGL 3.3 and, optionally, 4-sample multisampling
+    // 3.3 is needed for the packed 10:10:10:2 normals of the interleaved vertex format
     QSurfaceFormat format;
-    format.setVersion(3, 2);
+    format.setVersion(3, 3);
     format.setOption(QSurfaceFormat::DeprecatedFunctions, false);
     format.setProfile(QSurfaceFormat::CoreProfile);
     //format.setSamples(4);  // Uncomment for nice antialiasing. Not always supported.
@@ -38,8 +40,18 @@ int main(int argc, char *argv[])
     QSurfaceFormat::setDefaultFormat(format);
     debugFormatVersion();
 
+    // MICROMAYA_TRACE=file.json records a Chrome trace of the whole session
+    QByteArray tracePath = qgetenv("MICROMAYA_TRACE");
+    if (!tracePath.isEmpty()) {
+        Trace::start(tracePath.toStdString());
+    }
+
     MainWindow w;
     w.show();
 
-    return a.exec();
+    int result = a.exec();
+    if (!tracePath.isEmpty() && !Trace::stop()) {
+        qDebug() << "Failed to write the trace:" << Trace::error().c_str();
+    }
+    return result;
 }
@@ -2,32 +2,43 @@
 #include <ui_mainwindow.h>
 #include "cameracontrolshelp.h"
 #include "mygl.h"
+#include "trace.h"
+#include <QStatusBar>
+#include <QTimer>
+#include <algorithm>
+#include <cstdio>
+#include <string>
 
 
 MainWindow::MainWindow(QWidget *parent) :
     QMainWindow(parent),
-    ui(new Ui::MainWindow)
+    ui(new Ui::MainWindow), perfLabel(nullptr)
 {
     ui->setupUi(this);
     ui->mygl->setFocus();
-    // send vertices to gui
-    connect(ui->mygl, SIGNAL(sig_sendVertices(Vertex*)),
-            this, SLOT(slot_displayVertices(Vertex*)));
-    // send edges to gui
-    connect(ui->mygl, SIGNAL(sig_sendEdges(HalfEdge*)),
-            this, SLOT(slot_displayEdges(HalfEdge*)));
-    // send faces to gui
-    connect(ui->mygl, SIGNAL(sig_sendFaces(Face*)),
-            this, SLOT(slot_displayFaces(Face*)));
+
+    // element lists are models over the mesh, rows are built on demand
+    vertexModel = mkU<MeshListModel>(&ui->mygl->getMesh(), MeshListModel::VERTICES);
+    halfEdgeModel = mkU<MeshListModel>(&ui->mygl->getMesh(), MeshListModel::HALFEDGES);
+    faceModel = mkU<MeshListModel>(&ui->mygl->getMesh(), MeshListModel::FACES);
+    ui->vertsListView->setModel(vertexModel.get());
+    ui->halfEdgesListView->setModel(halfEdgeModel.get());
+    ui->facesListView->setModel(faceModel.get());
+
+    // mesh elements are about to change, and have changed
+    connect(ui->mygl, SIGNAL(sig_meshAboutToChange()),
+            this, SLOT(slot_meshAboutToChange()));
+    connect(ui->mygl, SIGNAL(sig_meshChanged()),
+            this, SLOT(slot_refreshLists()));
     // vertex is selected in gui
-    connect(ui->vertsListWidget, SIGNAL(itemClicked(QListWidgetItem*)),
-            ui->mygl, SLOT(slot_vertexSelected(QListWidgetItem*)));
+    connect(ui->vertsListView, SIGNAL(clicked(QModelIndex)),
+            this, SLOT(slot_vertexClicked(QModelIndex)));
     // edge is selected in gui
-    connect(ui->halfEdgesListWidget, SIGNAL(itemClicked(QListWidgetItem*)),
-            ui->mygl, SLOT(slot_halfEdgeSelected(QListWidgetItem*)));
+    connect(ui->halfEdgesListView, SIGNAL(clicked(QModelIndex)),
+            this, SLOT(slot_halfEdgeClicked(QModelIndex)));
     // face is selected in gui
-    connect(ui->facesListWidget, SIGNAL(itemClicked(QListWidgetItem*)),
-            ui->mygl, SLOT(slot_faceSelected(QListWidgetItem*)));
+    connect(ui->facesListView, SIGNAL(clicked(QModelIndex)),
+            this, SLOT(slot_faceClicked(QModelIndex)));
     // vertex is translated x in gui
     connect(ui->vertPosXSpinBox, SIGNAL(valueChanged(double)),
             ui->mygl, SLOT(slot_vertexTranslateX(double)));
@@ -56,8 +67,34 @@ MainWindow::MainWindow(QWidget *parent) :
             ui->mygl, SLOT(slot_subdivide()));
     connect(ui->extrudeBtn, SIGNAL(clicked(bool)),
             ui->mygl, SLOT(slot_extrude()));
+    connect(ui->deleteFaceBtn, SIGNAL(clicked(bool)),
+            ui->mygl, SLOT(slot_deleteFace()));
     connect(ui->loadBtn, SIGNAL(clicked(bool)),
             ui->mygl, SLOT(slot_readObj()));
+    // native binary mesh files
+    connect(ui->actionLoad_Mesh, SIGNAL(triggered()),
+            ui->mygl, SLOT(slot_readMesh()));
+    connect(ui->actionSave_Mesh, SIGNAL(triggered()),
+            ui->mygl, SLOT(slot_writeMesh()));
+    // obj or ply export
+    connect(ui->actionExport_Mesh, SIGNAL(triggered()),
+            ui->mygl, SLOT(slot_exportMesh()));
+    // number of threads used by subdivision
+    connect(ui->threadsSpinBox, SIGNAL(valueChanged(int)),
+            ui->mygl, SLOT(slot_setThreadCount(int)));
+    // smooth preview of the subdivided cage
+    connect(ui->smoothPreviewCheckBox, SIGNAL(toggled(bool)),
+            ui->mygl, SLOT(slot_setSmoothPreview(bool)));
+    connect(ui->smoothLevelSpinBox, SIGNAL(valueChanged(int)),
+            ui->mygl, SLOT(slot_setSmoothLevel(int)));
+
+    // performance HUD, the details are in its tooltip
+    perfLabel = new QLabel(this);
+    statusBar()->addPermanentWidget(perfLabel, 1);
+    QTimer *perfTimer = new QTimer(this);
+    connect(perfTimer, SIGNAL(timeout()),
+            this, SLOT(slot_updatePerf()));
+    perfTimer->start(250);
 
 }
 
@@ -77,16 +114,113 @@ void MainWindow::on_actionCamera_Controls_triggered()
     c->show();
 }
 
-void MainWindow::slot_displayVertices(Vertex *vertex) {
-    ui->vertsListWidget->addItem(vertex);
+void MainWindow::slot_meshAboutToChange() {
+    vertexModel->beginRefresh();
+    halfEdgeModel->beginRefresh();
+    faceModel->beginRefresh();
+}
+
+void MainWindow::slot_refreshLists() {
+    TRACE_SCOPE("MainWindow::slot_refreshLists");
+    vertexModel->endRefresh();
+    halfEdgeModel->endRefresh();
+    faceModel->endRefresh();
+}
+
+// list rows are element ids
+void MainWindow::slot_vertexClicked(const QModelIndex &index) {
+    ui->mygl->slot_vertexSelected(index.row());
+}
+
+void MainWindow::slot_halfEdgeClicked(const QModelIndex &index) {
+    ui->mygl->slot_halfEdgeSelected(index.row());
+}
+
+void MainWindow::slot_faceClicked(const QModelIndex &index) {
+    ui->mygl->slot_faceSelected(index.row());
+}
+
+namespace {
+
+// paintGL above this average, or an operation above operationLimitMs, turns the HUD red
+const double frameLimitMs = 33.0;
+const double operationLimitMs = 500.0;
+
+std::string format(const char *pattern, double value) {
+    char text[64];
+    std::snprintf(text, sizeof(text), pattern, value);
+    return text;
+}
+
+std::string formatBytes(size_t bytes) {
+    if (bytes >= 1024 * 1024) {
+        return format("%.1f MB", double(bytes) / (1024 * 1024));
+    }
+    return format("%.1f KB", double(bytes) / 1024);
 }
 
-void MainWindow::slot_displayEdges(HalfEdge *edge) {
-    ui->halfEdgesListWidget->addItem(edge);
+// one block character per histogram bin, scaled to the fullest bin
+std::string histogramBars(const std::vector<int> &bins) {
+    // empty, then U+2581 to U+2588 in UTF-8
+    static const char *bars[] = {" ", "\xe2\x96\x81", "\xe2\x96\x82", "\xe2\x96\x83", "\xe2\x96\x84",
+                                 "\xe2\x96\x85", "\xe2\x96\x86", "\xe2\x96\x87", "\xe2\x96\x88"};
+    int most = 1;
+    for (int count : bins) {
+        most = std::max(most, count);
+    }
+    std::string out;
+    for (int count : bins) {
+        out += bars[count == 0 ? 0 : 1 + count * 7 / most];
+    }
+    return out;
 }
 
+} // namespace
+
+void MainWindow::slot_updatePerf() {
+    const PerfStats &stats = ui->mygl->perfStats();
+    const PerfStats::OperationStats &op = stats.lastOperation();
+    std::vector<int> bins = stats.frameHistogram();
+
+    std::string text = "paint " + format("%.1f ms", stats.averageFrameMs()) +
+                       " [" + histogramBars(bins) + "]";
+    if (!op.name.empty()) {
+        text += "   " + op.name + format(" %.1f ms", op.ms);
+    }
+    text += "   " + std::to_string(stats.numVertices()) + " verts " +
+            std::to_string(stats.numHalfEdges()) + " halfedges " +
+            std::to_string(stats.numFaces()) + " faces";
+    text += "   GL " + formatBytes(stats.totalBufferBytes());
+
+    std::string details = "paintGL over the last " + std::to_string(stats.numFrames()) + " frames, max " +
+                          format("%.1f ms", stats.maxFrameMs()) + "\n";
+    for (int b = 0; b < PerfStats::histogramBins; b++) {
+        if (b + 1 < PerfStats::histogramBins) {
+            details += format("  < %g ms: ", PerfStats::histogramEdges[b]);
+        } else {
+            details += format("  >= %g ms: ", PerfStats::histogramEdges[b - 1]);
+        }
+        details += std::to_string(bins[b]) + "\n";
+    }
+    if (!op.name.empty()) {
+        details += op.name + format(" %.2f ms\n", op.ms);
+        for (const PerfStats::Phase &phase : op.phases) {
+            details += std::string(2 * phase.depth + 2, ' ') + phase.name + format(" %.2f ms", phase.ms);
+            if (phase.calls > 1) {
+                details += " (" + std::to_string(phase.calls) + " calls)";
+            }
+            details += "\n";
+        }
+    }
+    details += "GL buffers\n";
+    for (const PerfStats::BufferUsage &usage : stats.bufferUsage()) {
+        details += "  " + usage.drawable + " " + formatBytes(usage.bytes) + "\n";
+    }
+    details.pop_back();
 
-void MainWindow::slot_displayFaces(Face *face) {
-    ui->facesListWidget->addItem(face);
+    bool slow = stats.averageFrameMs() > frameLimitMs || op.ms > operationLimitMs;
+    perfLabel->setText(QString::fromStdString(text));
+    perfLabel->setToolTip(QString::fromStdString(details));
+    perfLabel->setStyleSheet(slow ? "color: red" : "");
 }
 
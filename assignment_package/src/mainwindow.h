@@ -1,12 +1,12 @@
 #ifndef MAINWINDOW_H
 #define MAINWINDOW_H
 
+#include <QLabel>
 #include <QMainWindow>
-#include "vertex.h"
-#include "face.h"
-#include "halfedge.h"
+#include <QModelIndex>
 #include <vector>
 #include "smartpointerhelp.h"
+#include "meshlistmodel.h"
 
 
 namespace Ui {
@@ -23,9 +23,12 @@ public:
     ~MainWindow();
 
 public slots:
-    void slot_displayVertices(Vertex*);
-    void slot_displayFaces(Face*);
-    void slot_displayEdges(HalfEdge*);
+    void slot_meshAboutToChange(); // starts resetting the element lists
+    void slot_refreshLists(); // rebuilds the element lists after a mesh change
+    void slot_vertexClicked(const QModelIndex&);
+    void slot_halfEdgeClicked(const QModelIndex&);
+    void slot_faceClicked(const QModelIndex&);
+    void slot_updatePerf(); // refreshes the performance HUD in the status bar
 
 private slots:
     void on_actionQuit_triggered();
@@ -35,6 +38,10 @@ private slots:
 
 private:
     Ui::MainWindow *ui;
+    uPtr<MeshListModel> vertexModel; // backs the vertex list
+    uPtr<MeshListModel> halfEdgeModel; // backs the halfedge list
+    uPtr<MeshListModel> faceModel; // backs the face list
+    QLabel *perfLabel; // performance HUD, owned by the status bar
 };
 
 
@@ -0,0 +1,118 @@
+#include "mappedfile.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::MappedFile()
+    : begin(nullptr), length(0)
+#ifdef _WIN32
+    , file(nullptr), mapping(nullptr)
+#endif
+{}
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+const char *MappedFile::data() const {
+    return begin;
+}
+
+size_t MappedFile::size() const {
+    return length;
+}
+
+#ifdef _WIN32
+
+bool MappedFile::open(const std::string &path) {
+    close();
+    HANDLE f = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                           OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (f == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(f, &fileSize)) {
+        CloseHandle(f);
+        return false;
+    }
+    file = f;
+    if (fileSize.QuadPart == 0) {
+        return true;
+    }
+    mapping = CreateFileMappingA(f, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!mapping) {
+        close();
+        return false;
+    }
+    begin = static_cast<const char*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+    if (!begin) {
+        close();
+        return false;
+    }
+    length = size_t(fileSize.QuadPart);
+    return true;
+}
+
+void MappedFile::close() {
+    if (begin) {
+        UnmapViewOfFile(begin);
+    }
+    if (mapping) {
+        CloseHandle(mapping);
+    }
+    if (file) {
+        CloseHandle(file);
+    }
+    begin = nullptr;
+    length = 0;
+    mapping = nullptr;
+    file = nullptr;
+}
+
+#else
+
+bool MappedFile::open(const std::string &path) {
+    close();
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0) {
+        ::close(fd);
+        return false;
+    }
+    if (info.st_size > 0) {
+        void *mem = mmap(nullptr, size_t(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mem == MAP_FAILED) {
+            ::close(fd);
+            return false;
+        }
+        // the file is read front to back
+        madvise(mem, size_t(info.st_size), MADV_SEQUENTIAL);
+        begin = static_cast<const char*>(mem);
+        length = size_t(info.st_size);
+    }
+    // the mapping keeps the file alive on its own
+    ::close(fd);
+    return true;
+}
+
+void MappedFile::close() {
+    if (begin) {
+        munmap(const_cast<char*>(begin), length);
+    }
+    begin = nullptr;
+    length = 0;
+}
+
+#endif
@@ -0,0 +1,29 @@
+#pragma once
+#include <cstddef>
+#include <string>
+
+// Read-only memory mapping of a whole file.
+// The contents stay valid until close() or destruction; an empty file
+// maps to size() == 0 with a null data() pointer.
+class MappedFile
+{
+public:
+    MappedFile();
+    ~MappedFile();
+    MappedFile(const MappedFile&) = delete;
+    MappedFile &operator=(const MappedFile&) = delete;
+
+    bool open(const std::string &path); // maps the file, false if it cannot be read
+    void close(); // unmaps the file
+
+    const char *data() const;
+    size_t size() const;
+
+private:
+    const char *begin; // first byte of the mapping
+    size_t length; // size of the mapping in bytes
+#ifdef _WIN32
+    void *file; // file handle
+    void *mapping; // file mapping handle
+#endif
+};
@@ -0,0 +1,39 @@
+#include "meshbuffers.h"
+#include "trace.h"
+
+uint32_t buildCornerLayout(const HalfEdgeMesh &mesh, std::vector<uint32_t> &faceCornerStart,
+                           std::vector<uint32_t> &indices) {
+    TRACE_SCOPE("buildCornerLayout");
+    // every halfedge is one corner of a face, and a face with n corners
+    // has n - 2 triangles, so the buffer sizes are known up front
+    int nFaces = mesh.numFaces();
+    indices.clear();
+    indices.reserve(3 * (mesh.numHalfEdges() - 2 * nFaces));
+    faceCornerStart.resize(nFaces + 1);
+
+    uint32_t i = 0;
+    for (uint32_t face = 0; face < uint32_t(nFaces); face++) {
+        faceCornerStart[face] = i;
+        uint32_t edgeCount = uint32_t(mesh.faceVertexCount(face));
+        for (uint32_t j = 1; j + 1 < edgeCount; j++) {
+            indices.push_back(i);
+            indices.push_back(i + j);
+            indices.push_back(i + j + 1);
+        }
+        i += edgeCount;
+    }
+    faceCornerStart[nFaces] = i;
+    return i;
+}
+
+void writeFaceCorners(const HalfEdgeMesh &mesh, uint32_t face, PackedVertex *out) {
+    uint32_t start = mesh.faceHalfEdge[face];
+    uint32_t curr = start;
+    glm::vec3 normal = mesh.faceNormal(face);
+    int i = 0;
+    do {
+        out[i] = PackedVertex(mesh.vertPos[mesh.heVertex[curr]], normal, mesh.faceColor[face]);
+        curr = mesh.heNext[curr];
+        i += 1;
+    } while (curr != start);
+}
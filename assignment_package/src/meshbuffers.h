@@ -0,0 +1,15 @@
+#pragma once
+#include "halfedgemesh.h"
+#include "packedvertex.h"
+#include <vector>
+
+// CPU side of Mesh::create, kept free of GL so it can run headless.
+// Face f owns the corners [faceCornerStart[f], faceCornerStart[f + 1]),
+// one per halfedge of its loop, and is fanned into triangles over them.
+
+// fills faceCornerStart (numFaces + 1 entries) and the triangle indices, returns the corner count
+uint32_t buildCornerLayout(const HalfEdgeMesh &mesh, std::vector<uint32_t> &faceCornerStart,
+                           std::vector<uint32_t> &indices);
+
+// writes the corners of a face, every corner gets the face normal and color
+void writeFaceCorners(const HalfEdgeMesh &mesh, uint32_t face, PackedVertex *out);
@@ -0,0 +1,192 @@
+#include "meshbuilder.h"
+#include "arena.h"
+#include "parallel.h"
+#include "trace.h"
+#include <algorithm>
+#include <cstdlib>
+
+void MeshBuildReport::clear() {
+    boundaryEdges.clear();
+    nonManifoldEdges.clear();
+}
+
+namespace {
+
+const uint64_t emptyKey = ~uint64_t(0); // no valid vertex pair packs to this
+const uint32_t duplicate = HalfEdgeMesh::NONE - 1; // value of an edge used by more than two halfedges
+
+// what pairing did with a halfedge
+enum EdgeState : char
+{
+    EDGE_PAIRED = 0,
+    EDGE_BOUNDARY = 1,
+    EDGE_NON_MANIFOLD = 2
+};
+
+// undirected edge, both halfedges of an edge get the same key
+inline uint64_t edgeKey(uint32_t a, uint32_t b) {
+    return a < b ? (uint64_t(a) << 32) | b : (uint64_t(b) << 32) | a;
+}
+
+// 64-bit finalizer from MurmurHash3, spreads neighbouring vertex ids over the table
+inline uint64_t hashKey(uint64_t key) {
+    key ^= key >> 33;
+    key *= 0xff51afd7ed558ccdull;
+    key ^= key >> 33;
+    key *= 0xc4ceb9fe1a85ec53ull;
+    key ^= key >> 33;
+    return key;
+}
+
+// linear probing table from edge to the first halfedge seen along it.
+// Key and value share an entry so a probe touches one cache line.
+class EdgeTable
+{
+public:
+    EdgeTable(size_t count, Arena &arena)
+        : mask(1), entries(ArenaAllocator<Entry>(&arena))
+    {
+        // at most two thirds full even if no edge is shared
+        while (mask + 1 < count + count / 2 + 1) {
+            mask = mask * 2 + 1;
+        }
+        entries.assign(mask + 1, Entry{emptyKey, HalfEdgeMesh::NONE});
+    }
+
+    // value stored under key, a new key starts out as NONE
+    uint32_t &find(uint64_t key) {
+        size_t slot = size_t(hashKey(key)) & mask;
+        while (entries[slot].key != key && entries[slot].key != emptyKey) {
+            slot = (slot + 1) & mask;
+        }
+        entries[slot].key = key;
+        return entries[slot].value;
+    }
+
+private:
+    struct Entry
+    {
+        uint64_t key;
+        uint32_t value;
+    };
+
+    size_t mask; // table size - 1, the size is a power of two
+    ArenaVector<Entry> entries;
+};
+
+} // namespace
+
+bool buildHalfEdgeMesh(const std::vector<glm::vec3> &positions,
+                       const std::vector<uint32_t> &faceStart,
+                       const std::vector<uint32_t> &faceIndices,
+                       HalfEdgeMesh &out, MeshBuildReport *report, int threads) {
+    TRACE_SCOPE("buildHalfEdgeMesh");
+    out.clear();
+    if (report) {
+        report->clear();
+    }
+    int nFaces = faceStart.empty() ? 0 : int(faceStart.size() - 1);
+    size_t nCorners = faceStart.empty() ? 0 : faceStart.back();
+    if (nCorners != faceIndices.size() || nCorners >= size_t(HalfEdgeMesh::NONE)) {
+        return false;
+    }
+    for (int f = 0; f < nFaces; f++) {
+        if (faceStart[f + 1] < faceStart[f] + 3) {
+            return false;
+        }
+    }
+    for (uint32_t v : faceIndices) {
+        if (v >= positions.size()) {
+            return false;
+        }
+    }
+
+    int nEdges = int(nCorners);
+    out.addVertices(uint32_t(positions.size()));
+    out.addHalfEdges(uint32_t(nEdges));
+    out.addFaces(uint32_t(nFaces));
+    std::copy(positions.begin(), positions.end(), out.vertPos.begin());
+    for (int f = 0; f < nFaces; f++) {
+        // same random colors as HalfEdgeMesh::addFace
+        out.faceColor[f] = glm::vec3(float(rand())/float((RAND_MAX)),
+                                     float(rand())/float((RAND_MAX)),
+                                     float(rand())/float((RAND_MAX)));
+    }
+
+    // halfedge c is corner c, so the face loops are laid out like the input
+    parallelFor(nFaces, threads, [&](int f) {
+        uint32_t first = faceStart[f];
+        uint32_t last = faceStart[f + 1];
+        for (uint32_t c = first; c < last; c++) {
+            out.heNext[c] = c + 1 < last ? c + 1 : first;
+            out.heVertex[c] = faceIndices[c];
+            out.heFace[c] = uint32_t(f);
+        }
+        out.faceHalfEdge[f] = first;
+    });
+    for (int c = 0; c < nEdges; c++) {
+        out.vertHalfEdge[faceIndices[c]] = uint32_t(c);
+    }
+
+    // vertex a halfedge starts at
+    auto from = [&](uint32_t he) {
+        uint32_t f = out.heFace[he];
+        return out.heVertex[he == faceStart[f] ? faceStart[f + 1] - 1 : he - 1];
+    };
+
+    // pair halfedges in one pass: the first halfedge along an edge waits
+    // in the table for one running the other way, anything beyond that
+    // makes the whole edge non-manifold
+    TRACE_SCOPE("buildHalfEdgeMesh pair twins");
+    ScratchScope scratch;
+    ArenaVector<char> state(nEdges, EDGE_PAIRED, scratch.allocator<char>());
+    EdgeTable table(nCorners, scratch.arena());
+    for (uint32_t he = 0; he < uint32_t(nEdges); he++) {
+        uint32_t a = from(he);
+        uint32_t b = out.heVertex[he];
+        if (a == b) {
+            state[he] = EDGE_NON_MANIFOLD;
+            continue;
+        }
+        uint32_t &first = table.find(edgeKey(a, b));
+        if (first == HalfEdgeMesh::NONE) {
+            first = he;
+        } else if (first == duplicate) {
+            state[he] = EDGE_NON_MANIFOLD;
+        } else if (out.heSym[first] == HalfEdgeMesh::NONE && out.heVertex[first] != b) {
+            out.heSym[first] = he;
+            out.heSym[he] = first;
+        } else {
+            // same direction twice, or a third halfedge
+            state[he] = EDGE_NON_MANIFOLD;
+            state[first] = EDGE_NON_MANIFOLD;
+            uint32_t sym = out.heSym[first];
+            if (sym != HalfEdgeMesh::NONE) {
+                state[sym] = EDGE_NON_MANIFOLD;
+                out.heSym[sym] = HalfEdgeMesh::NONE;
+                out.heSym[first] = HalfEdgeMesh::NONE;
+            }
+            first = duplicate;
+        }
+    }
+    for (int he = 0; he < nEdges; he++) {
+        if (state[he] == EDGE_PAIRED && out.heSym[he] == HalfEdgeMesh::NONE) {
+            state[he] = EDGE_BOUNDARY;
+        }
+    }
+
+    if (report) {
+        for (int he = 0; he < nEdges; he++) {
+            if (state[he] == EDGE_BOUNDARY) {
+                report->boundaryEdges.push_back(uint32_t(he));
+            } else if (state[he] == EDGE_NON_MANIFOLD) {
+                report->nonManifoldEdges.push_back(uint32_t(he));
+            }
+        }
+    }
+    return true;
+}
+
+bool buildHalfEdgeMesh(const ObjData &obj, HalfEdgeMesh &out, MeshBuildReport *report, int threads) {
+    return buildHalfEdgeMesh(obj.positions, obj.faceStart, obj.facePositions, out, report, threads);
+}
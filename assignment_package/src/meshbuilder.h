@@ -0,0 +1,32 @@
+#pragma once
+#include "halfedgemesh.h"
+#include "objreader.h"
+#include <vector>
+
+// Edges the builder could not pair up.
+// Both lists hold halfedge ids of the built mesh in increasing order;
+// every listed halfedge is left with heSym == NONE.
+struct MeshBuildReport
+{
+    std::vector<uint32_t> boundaryEdges; // no halfedge runs the opposite way
+    std::vector<uint32_t> nonManifoldEdges; // the edge is used by more than two faces, twice in the
+                                            // same direction (flipped face) or has equal endpoints
+
+    void clear();
+};
+
+// Builds halfedge connectivity from a polygon soup.
+// The corners of face f are faceIndices[faceStart[f]] up to
+// faceIndices[faceStart[f + 1]], counter-clockwise; halfedge c points to
+// the vertex of corner c. Twins are matched in one pass through an open
+// addressing hash table keyed by the edge's vertex pair packed into 64
+// bits, so no allocation happens per edge. Returns false and leaves out
+// empty if a face has fewer than 3 corners or an index is out of range.
+// threads <= 0 uses every core, 1 runs serially.
+bool buildHalfEdgeMesh(const std::vector<glm::vec3> &positions,
+                       const std::vector<uint32_t> &faceStart,
+                       const std::vector<uint32_t> &faceIndices,
+                       HalfEdgeMesh &out, MeshBuildReport *report = nullptr, int threads = 0);
+
+// same for the faces of an OBJ file
+bool buildHalfEdgeMesh(const ObjData &obj, HalfEdgeMesh &out, MeshBuildReport *report = nullptr, int threads = 0);
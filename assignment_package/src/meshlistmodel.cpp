@@ -0,0 +1,48 @@
+#include "meshlistmodel.h"
+#include "trace.h"
+
+MeshListModel::MeshListModel(const HalfEdgeMesh *mesh, ElementType type, QObject *parent)
+    : QAbstractListModel(parent), mesh(mesh), type(type), resetting(false)
+{}
+
+int MeshListModel::rowCount(const QModelIndex &parent) const {
+    // flat list, no children
+    if (parent.isValid()) {
+        return 0;
+    }
+    switch (type) {
+    case VERTICES:
+        return mesh->numVertices();
+    case HALFEDGES:
+        return mesh->numHalfEdges();
+    case FACES:
+        return mesh->numFaces();
+    }
+    return 0;
+}
+
+QVariant MeshListModel::data(const QModelIndex &index, int role) const {
+    if (!index.isValid() || role != Qt::DisplayRole) {
+        return QVariant();
+    }
+    // element ids are the row numbers
+    return QString::number(index.row());
+}
+
+// one reset per operation instead of one insertion per element. Views
+// may read rows until beginResetModel, so it has to run while the old
+// elements are still there.
+void MeshListModel::beginRefresh() {
+    if (!resetting) {
+        resetting = true;
+        beginResetModel();
+    }
+}
+
+void MeshListModel::endRefresh() {
+    TRACE_SCOPE("MeshListModel::endRefresh");
+    // a change nobody announced still gets a complete reset
+    beginRefresh();
+    resetting = false;
+    endResetModel();
+}
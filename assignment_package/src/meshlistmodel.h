@@ -0,0 +1,28 @@
+#pragma once
+#include <QAbstractListModel>
+#include "halfedgemesh.h"
+
+// List model exposing the ids of one kind of mesh element.
+// Rows are element ids and are only turned into text when a view
+// asks for them, so no per-element items are kept around.
+class MeshListModel : public QAbstractListModel
+{
+    Q_OBJECT
+
+public:
+    enum ElementType { VERTICES, HALFEDGES, FACES };
+
+    MeshListModel(const HalfEdgeMesh *mesh, ElementType type, QObject *parent = nullptr);
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+
+    // a reset spans the change: begin before the mesh is touched, end after
+    void beginRefresh();
+    void endRefresh();
+
+private:
+    const HalfEdgeMesh *mesh; // mesh whose elements are listed
+    ElementType type; // kind of element listed
+    bool resetting; // between beginRefresh and endRefresh
+};
@@ -0,0 +1,374 @@
+#include "meshwriter.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+namespace {
+
+// fixed size output buffer in front of a FILE
+class BufferedWriter
+{
+public:
+    BufferedWriter()
+        : file(nullptr), buffer(size_t(1) << 20), used(0), failed(false)
+    {}
+
+    ~BufferedWriter() {
+        close();
+    }
+
+    bool open(const std::string &path) {
+        file = std::fopen(path.c_str(), "wb");
+        return file != nullptr;
+    }
+
+    // flushes and closes, false if anything failed to write
+    bool close() {
+        if (file) {
+            flush();
+            failed = std::fclose(file) != 0 || failed;
+            file = nullptr;
+        }
+        return !failed;
+    }
+
+    // room for at least count more bytes
+    char *reserve(size_t count) {
+        if (used + count > buffer.size()) {
+            flush();
+        }
+        return buffer.data() + used;
+    }
+
+    void commit(char *end) {
+        used = size_t(end - buffer.data());
+    }
+
+    void write(const void *data, size_t count) {
+        if (count > buffer.size()) {
+            flush();
+            failed = std::fwrite(data, 1, count, file) != count || failed;
+            return;
+        }
+        char *out = reserve(count);
+        std::memcpy(out, data, count);
+        commit(out + count);
+    }
+
+    void write(const char *text) {
+        write(text, std::strlen(text));
+    }
+
+private:
+    FILE *file;
+    std::vector<char> buffer;
+    size_t used; // bytes waiting in buffer
+    bool failed; // a write or close failed
+
+    void flush() {
+        if (used > 0) {
+            failed = std::fwrite(buffer.data(), 1, used, file) != used || failed;
+            used = 0;
+        }
+    }
+};
+
+const double powersOfTen[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+// 10^exponent for |exponent| < 64, exact up to 1e22
+double powerOfTen(int exponent) {
+    double result = 1.0;
+    int e = exponent < 0 ? -exponent : exponent;
+    while (e > 22) {
+        result *= 1e22;
+        e -= 22;
+    }
+    result *= powersOfTen[e];
+    return exponent < 0 ? 1.0 / result : result;
+}
+
+// writes decimal digits of value, returns the end
+char *formatUint(uint64_t value, char *out) {
+    char digits[20];
+    int count = 0;
+    do {
+        digits[count++] = char('0' + value % 10);
+        value /= 10;
+    } while (value > 0);
+    while (count > 0) {
+        *out++ = digits[--count];
+    }
+    return out;
+}
+
+// shortest form of value with 9 significant digits, returns the end; needs 16 bytes
+char *formatFloat(float value, char *out) {
+    if (value == 0.0f) {
+        *out++ = '0';
+        return out;
+    }
+    if (!std::isfinite(value)) {
+        return out + std::sprintf(out, "%g", double(value));
+    }
+    double v = double(value);
+    if (v < 0) {
+        *out++ = '-';
+        v = -v;
+    }
+
+    // v = 0.d1d2...d9 * 10^(exponent + 1)
+    int exponent = int(std::floor(std::log10(v)));
+    uint64_t digits = uint64_t(std::llround(v * powerOfTen(8 - exponent)));
+    // log10 can be one off near powers of ten
+    if (digits < 100000000ull) {
+        exponent -= 1;
+        digits = uint64_t(std::llround(v * powerOfTen(8 - exponent)));
+    }
+    if (digits >= 1000000000ull) {
+        exponent += 1;
+        digits = uint64_t(std::llround(v * powerOfTen(8 - exponent)));
+    }
+    int count = 9;
+    while (count > 1 && digits % 10 == 0) {
+        digits /= 10;
+        count -= 1;
+    }
+    char text[9];
+    for (int i = count - 1; i >= 0; i--) {
+        text[i] = char('0' + digits % 10);
+        digits /= 10;
+    }
+
+    if (exponent >= 0 && exponent < 9) {
+        // ddd.ddd
+        for (int i = 0; i <= exponent; i++) {
+            *out++ = i < count ? text[i] : '0';
+        }
+        if (count > exponent + 1) {
+            *out++ = '.';
+            for (int i = exponent + 1; i < count; i++) {
+                *out++ = text[i];
+            }
+        }
+    } else if (exponent < 0 && exponent >= -5) {
+        // 0.000ddd
+        *out++ = '0';
+        *out++ = '.';
+        for (int i = -1; i > exponent; i--) {
+            *out++ = '0';
+        }
+        for (int i = 0; i < count; i++) {
+            *out++ = text[i];
+        }
+    } else {
+        // d.ddde-xx
+        *out++ = text[0];
+        if (count > 1) {
+            *out++ = '.';
+            for (int i = 1; i < count; i++) {
+                *out++ = text[i];
+            }
+        }
+        *out++ = 'e';
+        if (exponent < 0) {
+            *out++ = '-';
+            exponent = -exponent;
+        }
+        out = formatUint(uint64_t(exponent), out);
+    }
+    return out;
+}
+
+inline bool hasExtension(const std::string &path, const char *extension) {
+    size_t length = std::strlen(extension);
+    if (path.size() < length) {
+        return false;
+    }
+    for (size_t i = 0; i < length; i++) {
+        char c = path[path.size() - length + i];
+        if (c >= 'A' && c <= 'Z') {
+            c = char(c - 'A' + 'a');
+        }
+        if (c != extension[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+MeshWriter::MeshWriter()
+    : compact(false), message()
+{}
+
+void MeshWriter::setCompact(bool compact) {
+    this->compact = compact;
+}
+
+const std::string &MeshWriter::error() const {
+    return message;
+}
+
+uint32_t MeshWriter::vertexIndices(const HalfEdgeMesh &mesh, std::vector<uint32_t> &remap) const {
+    uint32_t nVertices = uint32_t(mesh.numVertices());
+    if (!compact) {
+        remap.resize(nVertices);
+        for (uint32_t v = 0; v < nVertices; v++) {
+            remap[v] = v;
+        }
+        return nVertices;
+    }
+    remap.assign(nVertices, HalfEdgeMesh::NONE);
+    for (int f = 0; f < mesh.numFaces(); f++) {
+        uint32_t first = mesh.faceHalfEdge[f];
+        uint32_t he = first;
+        do {
+            remap[mesh.heVertex[he]] = 0;
+            he = mesh.heNext[he];
+        } while (he != first);
+    }
+    uint32_t kept = 0;
+    for (uint32_t &index : remap) {
+        if (index != HalfEdgeMesh::NONE) {
+            index = kept++;
+        }
+    }
+    return kept;
+}
+
+bool MeshWriter::writeObj(const std::string &path, const HalfEdgeMesh &mesh) {
+    message.clear();
+    BufferedWriter out;
+    if (!out.open(path)) {
+        message = "cannot open " + path;
+        return false;
+    }
+    std::vector<uint32_t> remap;
+    vertexIndices(mesh, remap);
+
+    for (int v = 0; v < mesh.numVertices(); v++) {
+        if (remap[v] == HalfEdgeMesh::NONE) {
+            continue;
+        }
+        const glm::vec3 &pos = mesh.vertPos[v];
+        char *p = out.reserve(64);
+        *p++ = 'v';
+        for (int i = 0; i < 3; i++) {
+            *p++ = ' ';
+            p = formatFloat(pos[i], p);
+        }
+        *p++ = '\n';
+        out.commit(p);
+    }
+
+    for (int f = 0; f < mesh.numFaces(); f++) {
+        char *p = out.reserve(2);
+        *p++ = 'f';
+        out.commit(p);
+        uint32_t first = mesh.faceHalfEdge[f];
+        uint32_t he = first;
+        do {
+            p = out.reserve(16);
+            *p++ = ' ';
+            p = formatUint(uint64_t(remap[mesh.heVertex[he]]) + 1, p);
+            out.commit(p);
+            he = mesh.heNext[he];
+        } while (he != first);
+        p = out.reserve(1);
+        *p++ = '\n';
+        out.commit(p);
+    }
+
+    if (!out.close()) {
+        message = "cannot write " + path;
+        return false;
+    }
+    return true;
+}
+
+bool MeshWriter::writePly(const std::string &path, const HalfEdgeMesh &mesh) {
+    message.clear();
+    const uint32_t one = 1;
+    if (*reinterpret_cast<const unsigned char*>(&one) != 1) {
+        message = "binary PLY output needs a little-endian machine";
+        return false;
+    }
+    BufferedWriter out;
+    if (!out.open(path)) {
+        message = "cannot open " + path;
+        return false;
+    }
+    std::vector<uint32_t> remap;
+    uint32_t nVertices = vertexIndices(mesh, remap);
+
+    // vertex counts above 255 need a wider list size
+    uint32_t maxCorners = 0;
+    for (int f = 0; f < mesh.numFaces(); f++) {
+        maxCorners = std::max(maxCorners, uint32_t(mesh.faceVertexCount(uint32_t(f))));
+    }
+    bool smallFaces = maxCorners <= 255;
+
+    char header[512];
+    std::snprintf(header, sizeof(header),
+                  "ply\n"
+                  "format binary_little_endian 1.0\n"
+                  "element vertex %u\n"
+                  "property float x\n"
+                  "property float y\n"
+                  "property float z\n"
+                  "element face %d\n"
+                  "property list %s int vertex_indices\n"
+                  "property uchar red\n"
+                  "property uchar green\n"
+                  "property uchar blue\n"
+                  "end_header\n",
+                  nVertices, mesh.numFaces(), smallFaces ? "uchar" : "uint");
+    out.write(header);
+
+    for (int v = 0; v < mesh.numVertices(); v++) {
+        if (remap[v] != HalfEdgeMesh::NONE) {
+            out.write(&mesh.vertPos[v], sizeof(glm::vec3));
+        }
+    }
+
+    for (int f = 0; f < mesh.numFaces(); f++) {
+        uint32_t first = mesh.faceHalfEdge[f];
+        uint32_t corners = uint32_t(mesh.faceVertexCount(uint32_t(f)));
+        if (smallFaces) {
+            unsigned char count = (unsigned char)corners;
+            out.write(&count, 1);
+        } else {
+            out.write(&corners, sizeof(corners));
+        }
+        uint32_t he = first;
+        do {
+            int32_t index = int32_t(remap[mesh.heVertex[he]]);
+            out.write(&index, sizeof(index));
+            he = mesh.heNext[he];
+        } while (he != first);
+        unsigned char color[3];
+        for (int i = 0; i < 3; i++) {
+            float c = glm::clamp(mesh.faceColor[f][i], 0.0f, 1.0f);
+            color[i] = (unsigned char)(c * 255.0f + 0.5f);
+        }
+        out.write(color, sizeof(color));
+    }
+
+    if (!out.close()) {
+        message = "cannot write " + path;
+        return false;
+    }
+    return true;
+}
+
+bool MeshWriter::write(const std::string &path, const HalfEdgeMesh &mesh) {
+    if (hasExtension(path, ".ply")) {
+        return writePly(path, mesh);
+    }
+    return writeObj(path, mesh);
+}
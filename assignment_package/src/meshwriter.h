@@ -0,0 +1,30 @@
+#pragma once
+#include "halfedgemesh.h"
+#include <string>
+
+// Streams a mesh out as OBJ text or binary little-endian PLY.
+// Faces are walked through their halfedge loops and written through a
+// fixed size buffer, so memory stays bounded by one index per vertex
+// no matter how large the mesh is. Floats are formatted by hand with
+// 9 significant digits, enough to read back the same float.
+class MeshWriter
+{
+public:
+    MeshWriter();
+
+    // drop vertices no face uses and renumber the rest in order
+    void setCompact(bool compact);
+
+    bool writeObj(const std::string &path, const HalfEdgeMesh &mesh); // false on failure, see error()
+    bool writePly(const std::string &path, const HalfEdgeMesh &mesh); // includes face colors
+    bool write(const std::string &path, const HalfEdgeMesh &mesh); // picks the format from the extension
+
+    const std::string &error() const; // what went wrong in the last write
+
+private:
+    bool compact; // whether unused vertices are dropped
+    std::string message; // last error
+
+    // new index of every vertex, NONE for dropped ones; returns the number kept
+    uint32_t vertexIndices(const HalfEdgeMesh &mesh, std::vector<uint32_t> &remap) const;
+};
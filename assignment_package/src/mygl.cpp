@@ -1,6 +1,14 @@
 #include "mygl.h"
 #include <la.h>
-
+#include "subdivision.h"
+#include "objreader.h"
+#include "meshbuilder.h"
+#include "hemeshfile.h"
+#include "jobsystem.h"
+#include "meshwriter.h"
+#include "trace.h"
+
+#include <chrono>
 #include <iostream>
 #include <QApplication>
 #include <QKeyEvent>
@@ -9,14 +17,16 @@
 #include <fstream>
 #include <sstream>
 #include <QStringList>
+#include <map>
 
 
 MyGL::MyGL(QWidget *parent)
     : OpenGLContext(parent),
-      m_geomSquare(this), m_mesh(this),
+      m_geomSquare(this), m_mesh(this), m_smoothMesh(this), m_smoothCache(m_mesh),
       m_progLambert(this), m_progFlat(this),
       m_glCamera(), vDisplay(this), eDisplay(this), fDisplay(this),
-      selectedVertex(nullptr), selectedEdge(nullptr), selectedFace(nullptr)
+      selectedVertex(), selectedEdge(), selectedFace(), threadCount(0),
+      smoothPreview(false), smoothLevel(1)
 {
     setFocusPolicy(Qt::StrongFocus);
 }
@@ -24,14 +34,29 @@ MyGL::MyGL(QWidget *parent)
 MyGL::~MyGL()
 {
     makeCurrent();
-    glDeleteVertexArrays(1, &vao);
     m_mesh.destroy();
+    m_smoothMesh.destroy();
     m_geomSquare.destroy();
     vDisplay.destroy();
     eDisplay.destroy();
     fDisplay.destroy();
 }
 
+const HalfEdgeMesh &MyGL::getMesh() const {
+    return m_mesh;
+}
+
+const PerfStats &MyGL::perfStats() {
+    m_perfStats.setElementCounts(m_mesh.numVertices(), m_mesh.numHalfEdges(), m_mesh.numFaces());
+    m_perfStats.setBufferBytes("mesh", m_mesh.gpuBytes());
+    m_perfStats.setBufferBytes("smooth preview", m_smoothMesh.gpuBytes());
+    m_perfStats.setBufferBytes("vertex", vDisplay.gpuBytes());
+    m_perfStats.setBufferBytes("halfedge", eDisplay.gpuBytes());
+    m_perfStats.setBufferBytes("face", fDisplay.gpuBytes());
+    m_perfStats.setBufferBytes("square", m_geomSquare.gpuBytes());
+    return m_perfStats;
+}
+
 void MyGL::initializeGL()
 {
     // Create an OpenGL context using Qt's QOpenGLFunctions_3_2_Core class
@@ -53,10 +78,8 @@ void MyGL::initializeGL()
 
     printGLErrorLog();
 
-    // Create a Vertex Attribute Object
-    glGenVertexArrays(1, &vao);
-
     m_mesh.destroy();
+    emit sig_meshAboutToChange();
     m_mesh.createCube();
     m_mesh.create();
 
@@ -79,19 +102,9 @@ void MyGL::initializeGL()
     m_progFlat.create(":/glsl/flat.vert.glsl", ":/glsl/flat.frag.glsl");
 
 
-    // We have to have a VAO bound in OpenGL 3.2 Core. But if we're not
-    // using multiple VAOs, we can just bind one once.
-    glBindVertexArray(vao);
+    // Every Drawable owns a VAO, bound by ShaderProgram::draw
 
-    for (auto &pointer : m_mesh.vertices) {
-        emit sig_sendVertices(pointer.get());
-    }
-    for (auto &pointer : m_mesh.edges) {
-        emit sig_sendEdges(pointer.get());
-    }
-    for (auto &pointer : m_mesh.faces) {
-        emit sig_sendFaces(pointer.get());
-    }
+    sendSignalsMesh();
 
 }
 
@@ -114,6 +127,11 @@ void MyGL::resizeGL(int w, int h)
 //For example, when the function update() is called, paintGL is called implicitly.
 void MyGL::paintGL()
 {
+    TRACE_SCOPE("MyGL::paintGL");
+    auto frameStart = std::chrono::steady_clock::now();
+    // Qt may touch GL state between frames, so the bind cache starts over
+    resetStateCache();
+
     // Clear the screen so that we only see newly drawn images
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
@@ -140,7 +158,11 @@ void MyGL::paintGL()
 
     m_progLambert.setModelMatrix(model);
     //m_progLambert.draw(m_geomSquare);
-    m_progLambert.draw(m_mesh);
+    if (smoothPreview) {
+        m_progLambert.draw(m_smoothMesh);
+    } else {
+        m_progLambert.draw(m_mesh);
+    }
 
     glDisable(GL_DEPTH_TEST);
     m_progFlat.setModelMatrix(model);
@@ -150,6 +172,9 @@ void MyGL::paintGL()
 
 
     glEnable(GL_DEPTH_TEST);
+
+    auto frameEnd = std::chrono::steady_clock::now();
+    m_perfStats.addFrame(std::chrono::duration<double, std::milli>(frameEnd - frameStart).count());
 }
 
 
@@ -190,35 +215,39 @@ void MyGL::keyPressEvent(QKeyEvent *e)
         m_glCamera.TranslateAlongUp(amount);
     } else if (e->key() == Qt::Key_R) {
         m_glCamera = Camera(this->width(), this->height());
-    } else if (e->key() == Qt::Key_N) {
-        slot_halfEdgeSelected(selectedEdge->next);
-    } else if (e->key() == Qt::Key_M) {
-        slot_halfEdgeSelected(selectedEdge->sym);
-    } else if (e->key() == Qt::Key_F) {
-        slot_faceSelected(selectedEdge->face);
-    } else if (e->key() == Qt::Key_V) {
-        slot_vertexSelected(selectedEdge->vertex);
+    } else if (e->key() == Qt::Key_N && selectedEdge.isValid()) {
+        slot_halfEdgeSelected(selectedEdge.next().id());
+    } else if (e->key() == Qt::Key_M && selectedEdge.isValid()) {
+        slot_halfEdgeSelected(selectedEdge.sym().id());
+    } else if (e->key() == Qt::Key_F && selectedEdge.isValid()) {
+        slot_faceSelected(selectedEdge.face().id());
+    } else if (e->key() == Qt::Key_V && selectedEdge.isValid()) {
+        slot_vertexSelected(selectedEdge.vertex().id());
     } else if ((e->modifiers() & Qt::ShiftModifier) && e->key() == Qt::Key_H) {
-        slot_halfEdgeSelected(selectedFace->halfedge);
-    } else if (e->key() == Qt::Key_H) {
-        slot_halfEdgeSelected(selectedVertex->halfedge);
+        if (selectedFace.isValid()) {
+            slot_halfEdgeSelected(selectedFace.halfedge().id());
+        }
+    } else if (e->key() == Qt::Key_H && selectedVertex.isValid()) {
+        slot_halfEdgeSelected(selectedVertex.halfedge().id());
+    } else if (e->key() == Qt::Key_Delete && selectedFace.isValid()) {
+        slot_deleteFace();
     }
     m_glCamera.RecomputeAttributes();
     update();  // Calls paintGL, among other things
 }
 
 // slot for vertex selection
-void MyGL::slot_vertexSelected(QListWidgetItem* v) {
-    Vertex *vertex = dynamic_cast<Vertex*>(v);
-    if (vertex) {
+void MyGL::slot_vertexSelected(int id) {
+    Vertex vertex = m_mesh.vertex(id);
+    if (vertex.isValid()) {
         selectedVertex = vertex;
         vDisplay.updateVertex(vertex);
         vDisplay.destroy();
         vDisplay.create();
-        selectedEdge = nullptr;
-        eDisplay.updateEdge(nullptr);
-        fDisplay.updateFace(nullptr);
-        selectedFace = nullptr;
+        selectedEdge = HalfEdge();
+        eDisplay.updateEdge(HalfEdge());
+        fDisplay.updateFace(Face());
+        selectedFace = Face();
         eDisplay.destroy();
         eDisplay.create();
         fDisplay.destroy();
@@ -228,18 +257,18 @@ void MyGL::slot_vertexSelected(QListWidgetItem* v) {
 }
 
 // slot for edge selection
-void MyGL::slot_halfEdgeSelected(QListWidgetItem* e) {
-    HalfEdge *edge = dynamic_cast<HalfEdge*>(e);
+void MyGL::slot_halfEdgeSelected(int id) {
+    HalfEdge edge = m_mesh.halfEdge(id);
 
-    if (edge) {
+    if (edge.isValid()) {
         selectedEdge = edge;
         eDisplay.updateEdge(edge);
         eDisplay.destroy();
         eDisplay.create();
-        selectedVertex = nullptr;
-        vDisplay.updateVertex(nullptr);
-        fDisplay.updateFace(nullptr);
-        selectedFace = nullptr;
+        selectedVertex = Vertex();
+        vDisplay.updateVertex(Vertex());
+        fDisplay.updateFace(Face());
+        selectedFace = Face();
         vDisplay.destroy();
         vDisplay.create();
         fDisplay.destroy();
@@ -249,19 +278,19 @@ void MyGL::slot_halfEdgeSelected(QListWidgetItem* e) {
 }
 
 // slot for face selection
-void MyGL::slot_faceSelected(QListWidgetItem* f) {
-    Face *face = dynamic_cast<Face*>(f);
+void MyGL::slot_faceSelected(int id) {
+    Face face = m_mesh.face(id);
 
-    if (face) {
+    if (face.isValid()) {
         selectedFace = face;
         fDisplay.updateFace(face);
         fDisplay.destroy();
         fDisplay.create();
         this->update();
-        selectedEdge = nullptr;
-        eDisplay.updateEdge(nullptr);
-        vDisplay.updateVertex(nullptr);
-        selectedVertex = nullptr;
+        selectedEdge = HalfEdge();
+        eDisplay.updateEdge(HalfEdge());
+        vDisplay.updateVertex(Vertex());
+        selectedVertex = Vertex();
         eDisplay.destroy();
         eDisplay.create();
         vDisplay.destroy();
@@ -271,10 +300,12 @@ void MyGL::slot_faceSelected(QListWidgetItem* f) {
 
 // slot for vertex translation in x
 void MyGL::slot_vertexTranslateX(double x) {
-    if (selectedVertex != nullptr) {
-        selectedVertex->pos.x = x;
-        m_mesh.destroy();
-        m_mesh.create();
+    if (selectedVertex.isValid()) {
+        PerfStats::Operation op(m_perfStats, "move vertex");
+        selectedVertex.pos().x = x;
+        m_mesh.markVertexDirty(selectedVertex.index);
+        m_mesh.update();
+        updateSmoothVertex(selectedVertex.index);
         vDisplay.destroy();
         vDisplay.create();
         this->update();
@@ -283,10 +314,12 @@ void MyGL::slot_vertexTranslateX(double x) {
 
 // slot for vertex translation in y
 void MyGL::slot_vertexTranslateY(double x) {
-    if (selectedVertex != nullptr) {
-        selectedVertex->pos.y = x;
-        m_mesh.destroy();
-        m_mesh.create();
+    if (selectedVertex.isValid()) {
+        PerfStats::Operation op(m_perfStats, "move vertex");
+        selectedVertex.pos().y = x;
+        m_mesh.markVertexDirty(selectedVertex.index);
+        m_mesh.update();
+        updateSmoothVertex(selectedVertex.index);
         vDisplay.destroy();
         vDisplay.create();
         this->update();
@@ -295,10 +328,12 @@ void MyGL::slot_vertexTranslateY(double x) {
 
 // slot for vertex translation in z
 void MyGL::slot_vertexTranslateZ(double x) {
-    if (selectedVertex != nullptr) {
-        selectedVertex->pos.z = x;
-        m_mesh.destroy();
-        m_mesh.create();
+    if (selectedVertex.isValid()) {
+        PerfStats::Operation op(m_perfStats, "move vertex");
+        selectedVertex.pos().z = x;
+        m_mesh.markVertexDirty(selectedVertex.index);
+        m_mesh.update();
+        updateSmoothVertex(selectedVertex.index);
         vDisplay.destroy();
         vDisplay.create();
         this->update();
@@ -307,10 +342,12 @@ void MyGL::slot_vertexTranslateZ(double x) {
 
 // slot for color change in r
 void MyGL::slot_changeFaceR(double x) {
-    if (selectedFace != nullptr) {
-        selectedFace->color.r = x;
-        m_mesh.destroy();
-        m_mesh.create();
+    if (selectedFace.isValid()) {
+        PerfStats::Operation op(m_perfStats, "recolor face");
+        selectedFace.color().r = x;
+        m_mesh.markFaceColorDirty(selectedFace.index);
+        m_mesh.update();
+        updateSmoothFace(selectedFace.index);
         fDisplay.destroy();
         fDisplay.create();
         this->update();
@@ -319,10 +356,12 @@ void MyGL::slot_changeFaceR(double x) {
 
 // slot for color change in g
 void MyGL::slot_changeFaceG(double x) {
-    if (selectedFace != nullptr) {
-        selectedFace->color.g = x;
-        m_mesh.destroy();
-        m_mesh.create();
+    if (selectedFace.isValid()) {
+        PerfStats::Operation op(m_perfStats, "recolor face");
+        selectedFace.color().g = x;
+        m_mesh.markFaceColorDirty(selectedFace.index);
+        m_mesh.update();
+        updateSmoothFace(selectedFace.index);
         fDisplay.destroy();
         fDisplay.create();
         this->update();
@@ -331,10 +370,12 @@ void MyGL::slot_changeFaceG(double x) {
 
 // slot for color change in b
 void MyGL::slot_changeFaceB(double x) {
-    if (selectedFace != nullptr) {
-        selectedFace->color.b = x;
-        m_mesh.destroy();
-        m_mesh.create();
+    if (selectedFace.isValid()) {
+        PerfStats::Operation op(m_perfStats, "recolor face");
+        selectedFace.color().b = x;
+        m_mesh.markFaceColorDirty(selectedFace.index);
+        m_mesh.update();
+        updateSmoothFace(selectedFace.index);
         fDisplay.destroy();
         fDisplay.create();
         this->update();
@@ -343,38 +384,13 @@ void MyGL::slot_changeFaceB(double x) {
 
 // slot for adding a vertex to current halfedge
 void MyGL::slot_addVertex() {
-    if (selectedEdge != nullptr) {
-        Vertex* v1 = selectedEdge->vertex;
-        Vertex* v2 = selectedEdge->sym->vertex;
-        HalfEdge *h1 = selectedEdge;
-        HalfEdge *h2 = selectedEdge->sym;
-        uPtr<Vertex> v3 = mkU<Vertex>();
-        v3->pos = glm::vec3((v1->pos.x + v2->pos.x) / 2,
-                            (v1->pos.y + v2->pos.y) / 2,
-                            (v1->pos.z + v2->pos.z) / 2);
-        uPtr<HalfEdge> e1 = mkU<HalfEdge>();
-        uPtr<HalfEdge> e2 = mkU<HalfEdge>();
-        e1->face = h1->face;
-        e2->face = h2->face;
-        e1->sym = h2;
-        e2->sym = h1;
-        h1->sym = e2.get();
-        h2->sym = e1.get();
-        e1->next = h1->next;
-        e2->next = h2->next;
-        h1->next = e1.get();
-        h2->next = e2.get();
-        e1->vertex = h1->vertex;
-        h1->vertex = v3.get();
-        e2->vertex = h2->vertex;
-        h2->vertex = v3.get();
-        emit sig_sendEdges(e1.get());
-        emit sig_sendEdges(e2.get());
-        emit sig_sendVertices(v3.get());
-        m_mesh.edges.push_back(std::move(e1));
-        m_mesh.edges.push_back(std::move(e2));
-        m_mesh.vertices.push_back(std::move(v3));
-        m_mesh.destroy();
+    if (selectedEdge.isValid()) {
+        PerfStats::Operation op(m_perfStats, "add vertex");
+        glm::vec3 v1 = selectedEdge.vertex().pos();
+        glm::vec3 v2 = selectedEdge.prevEdge().vertex().pos();
+        emit sig_meshAboutToChange();
+        m_mesh.splitEdge(selectedEdge.index, (v1 + v2) / 2.f);
+        sendSignalsMesh();
         m_mesh.create();
         eDisplay.destroy();
         eDisplay.create();
@@ -384,40 +400,12 @@ void MyGL::slot_addVertex() {
 
 // slot for triangulating the current face
 void MyGL::slot_triangulate() {
-    if (selectedFace != nullptr) {
-        int count = selectedFace->vertexCount();
-        Face *currFace = selectedFace;
-        // keep triangulating until every parts are triangles
-        for (int i = 0; i < count - 3; i++) {
-            HalfEdge *edge = currFace->halfedge;
-            uPtr<HalfEdge> e1 = mkU<HalfEdge>();
-            uPtr<HalfEdge> e2 = mkU<HalfEdge>();
-            e1->vertex = edge->vertex;
-            e2->vertex = edge->next->next->vertex;
-            e1->sym = e2.get();
-            e2->sym = e1.get();
-            uPtr<Face> f2 = mkU<Face>();
-            f2->color = glm::vec3(currFace->color.r,
-                                  currFace->color.g,
-                                  currFace->color.b);
-            e1->face = f2.get();
-            edge->next->face = f2.get();
-            edge->next->next->face = f2.get();
-            e2->face = currFace;
-            f2->halfedge = e1.get();
-            e2->next = edge->next->next->next;
-            edge->next->next->next = e1.get();
-            e1->next = edge->next;
-            edge->next = e2.get();
-            emit sig_sendEdges(e1.get());
-            emit sig_sendEdges(e2.get());
-            emit sig_sendFaces(f2.get());
-            m_mesh.edges.push_back(std::move(e1));
-            m_mesh.edges.push_back(std::move(e2));
-            m_mesh.faces.push_back(std::move(f2));
-        }
+    PerfStats::Operation op(m_perfStats, "triangulate");
+    if (selectedFace.isValid()) {
+        emit sig_meshAboutToChange();
+        m_mesh.triangulateFace(selectedFace.index);
+        sendSignalsMesh();
     }
-    m_mesh.destroy();
     m_mesh.create();
     fDisplay.destroy();
     fDisplay.create();
@@ -427,406 +415,250 @@ void MyGL::slot_triangulate() {
 
 /// slot for subdividing mesh
 void MyGL::slot_subdivide() {
-    // compute centroids of faces
-    computeCentroids();
-    // compute midpoints of edges
-    computeMidPts();
-    // smooth vertices of original vertices
-    smoothVertices();
-
-    std::map<int, HalfEdge*> nextMap;
-
-    std::vector<HalfEdge*> toSplit;
-    for (uPtr<HalfEdge> &e : m_mesh.edges) {
-        if (std::find(toSplit.begin(), toSplit.end(), e->sym) == toSplit.end()) {
-            toSplit.push_back(e.get());
-        }
-    }
-    for (HalfEdge *e : toSplit) {
-        splitByMidPt(e);
-    }
-    for (uPtr<HalfEdge> &e : m_mesh.edges) {
-        nextMap[e->id] = e->next;
+    PerfStats::Operation op(m_perfStats, "subdivide");
+    TRACE_SCOPE("MyGL::slot_subdivide");
+    HalfEdgeMesh refined;
+    {
+        TRACE_SCOPE("CatmullClark::refine");
+        CatmullClark(m_mesh, threadCount).refine(refined);
     }
+    emit sig_meshAboutToChange();
+    m_mesh.swap(refined);
+    // halfedge and face ids are renumbered by the subdivision
+    clearSelection();
+    sendSignalsMesh();
+    m_mesh.create();
+    this->update();
+}
 
+// sets the number of threads used by subdivision and the job pool, 0 uses every core
+void MyGL::slot_setThreadCount(int threads) {
+    threadCount = threads;
+    JobSystem::setThreads(threads);
+    m_smoothCache.setThreads(threads);
+}
 
-    std::vector<uPtr<Face>> newFaces;
-    // iterate through each face and subdivide
-    for (uPtr<Face> &face : m_mesh.faces) {
-        HalfEdge *curr = face->halfedge;
-        HalfEdge *start = face->halfedge;
-        uPtr<Vertex> ct = std::move(centroids[face->id]);
-        int count = face->vertexCount() / 2;
-        std::vector<uPtr<HalfEdge>> newEdges;
-
-        // make new edges
-        for (int i = 0; i < count; i++) {
-            uPtr<HalfEdge> e1 = mkU<HalfEdge>();
-            uPtr<HalfEdge> e2 = mkU<HalfEdge>();
-            if (i != 0) {
-                e2->sym = newEdges[newEdges.size()-2].get();
-                newEdges[newEdges.size()-2]->sym = e2.get();
-            }
-            newEdges.push_back(std::move(e1));
-            newEdges.push_back(std::move(e2));
-        }
-        newEdges[newEdges.size()-2]->sym = newEdges[1].get();
-        newEdges[1]->sym = newEdges[newEdges.size()-2].get();
-        int track = 0;
-
-
-        //quadrangulate faces
-        do {
-            HalfEdge *nextEdge = curr->next;
-            HalfEdge *e1 = newEdges[track].get();
-            HalfEdge *e2 = newEdges[track+1].get();
-
-            nextEdge->next = e1;
-            e1->next = e2;
-            e2->next = curr;
-            if (nextMap[nextEdge->id] == face->halfedge) {
-                e1->face = face.get();
-                e2->face = face.get();
-                face->halfedge = curr;
-            } else {
-                uPtr<Face> newFace = mkU<Face>();
-                curr->face = newFace.get();
-                nextEdge->face = newFace.get();
-                e1->face = newFace.get();
-                e2->face = newFace.get();
-                newFace->halfedge = curr;
-                newFaces.push_back(std::move(newFace));
-            }
-            e1->vertex = ct.get();
-            e2->vertex = curr->sym->vertex;
-            ct->halfedge = e1;
-            track += 2;
-            curr = nextMap[nextEdge->id];
-        } while (curr != start);
-
-        emit sig_sendVertices(ct.get());
-        m_mesh.vertices.push_back(std::move(ct));
-        for (uPtr<HalfEdge> &e : newEdges) {
-            emit sig_sendEdges(e.get());
-            m_mesh.edges.push_back(std::move(e));
-        }
-    }
-    for (uPtr<Face> &f : newFaces) {
-        emit sig_sendFaces(f.get());
-        m_mesh.faces.push_back(std::move(f));
-    }
-    m_mesh.destroy();
-    m_mesh.create();
+// slot for toggling the smooth preview
+void MyGL::slot_setSmoothPreview(bool on) {
+    PerfStats::Operation op(m_perfStats, "smooth preview");
+    smoothPreview = on;
+    updateSmoothMesh();
     this->update();
+}
 
+// slot for the level of the smooth preview
+void MyGL::slot_setSmoothLevel(int level) {
+    PerfStats::Operation op(m_perfStats, "smooth level");
+    smoothLevel = level < 1 ? 1 : level;
+    updateSmoothMesh();
+    this->update();
+}
 
+// rebuilds the smooth preview; levels stay cached until the topology changes
+void MyGL::updateSmoothMesh() {
+    if (!smoothPreview) {
+        return;
+    }
+    TRACE_SCOPE("MyGL::updateSmoothMesh");
+    m_smoothCache.refine(smoothLevel, m_smoothMesh);
+    m_smoothMesh.create();
 }
 
-// stores midpoints of edges
-void MyGL::splitByMidPt(HalfEdge *edge) {
-    HalfEdge *h1 = edge;
-    HalfEdge *h2 = edge->sym;
-    uPtr<Vertex> v3 = mkU<Vertex>();
-    v3->pos = glm::vec3(midPts[edge->id]->pos);
-    uPtr<HalfEdge> e1 = mkU<HalfEdge>();
-    uPtr<HalfEdge> e2 = mkU<HalfEdge>();
-    e1->face = h1->face;
-    e2->face = h2->face;
-    e1->sym = h2;
-    e2->sym = h1;
-    h1->sym = e2.get();
-    h2->sym = e1.get();
-    e1->next = h1->next;
-    e2->next = h2->next;
-    h1->next = e1.get();
-    h2->next = e2.get();
-    e1->vertex = h1->vertex;
-    h1->vertex = v3.get();
-    e2->vertex = h2->vertex;
-    h2->vertex = v3.get();
-    h1->face->halfedge = e1.get();
-    h2->face->halfedge = e2.get();
-    emit sig_sendEdges(e1.get());
-    emit sig_sendEdges(e2.get());
-    emit sig_sendVertices(v3.get());
-    m_mesh.edges.push_back(std::move(e1));
-    m_mesh.edges.push_back(std::move(e2));
-    m_mesh.vertices.push_back(std::move(v3));
-}
-
-// smooth vertices, used in subdivision
-void MyGL::smoothVertices() {
-    std::vector<glm::vec3> newVtxPos;
-
-    // iterate through vertices and smooth them
-    for (uPtr<Vertex> &vertex : m_mesh.vertices) {
-        glm::vec3 sum_e = glm::vec3(0.0, 0.0, 0.0);
-        glm::vec3 sum_f = glm::vec3(0.0, 0.0, 0.0);
-        int n = 0;
-        for (uPtr<HalfEdge> &edge : m_mesh.edges) {
-            if (edge->vertex == vertex.get()) {
-                n += 1;
-                sum_e += midPts[edge->id]->pos;
-                sum_f += centroids[edge->face->id]->pos;
-            }
-        }
-        // new position
-        glm::vec3 newPos = glm::vec3(vertex->pos[0] * (n - 2) / n,
-                                     vertex->pos[1] * (n - 2) / n,
-                                     vertex->pos[2] * (n - 2) / n) +
-                           glm::vec3(sum_e[0] / (n*n), sum_e[1] / (n*n), sum_e[2] / (n*n)) +
-                           glm::vec3(sum_f[0] / (n*n), sum_f[1] / (n*n), sum_f[2] / (n*n));
-        newVtxPos.push_back(newPos);
+// refreshes the smooth preview after cage vertex v has moved
+void MyGL::updateSmoothVertex(uint32_t v) {
+    if (!smoothPreview) {
+        return;
     }
-    int track = 0;
-    for (uPtr<Vertex> &vertex : m_mesh.vertices) {
-        vertex->pos = glm::vec3(newVtxPos[track][0], newVtxPos[track][1], newVtxPos[track][2]);
-        track += 1;
+    // only the refined vertices that depend on v move
+    m_smoothCache.updateVertex(smoothLevel, v, m_smoothMesh);
+    const StencilTable &stencils = m_smoothCache.stencils(smoothLevel);
+    for (uint32_t i = stencils.influenceStart[v]; i < stencils.influenceStart[v + 1]; i++) {
+        m_smoothMesh.markVertexDirty(stencils.influence[i]);
     }
+    m_smoothMesh.update();
 }
 
-// split by mid points, used in subdivision
-void MyGL::computeMidPts() {
-    midPts.clear();
-    for (uPtr<Face> &face : m_mesh.faces) {
-        HalfEdge *curr = face->halfedge;
-        do {
-            uPtr<Vertex> v = mkU<Vertex>();
-            glm::vec3 pos = glm::vec3(0.0, 0.0, 0.0);
-            pos += curr->vertex->pos;
-            pos += curr->sym->vertex->pos;
-            pos += centroids[face->id]->pos;
-            if (curr->sym != nullptr) {
-                pos += centroids[curr->sym->face->id]->pos;
-                pos[0] = pos[0] / 4.0;
-                pos[1] = pos[1] / 4.0;
-                pos[2] = pos[2] / 4.0;
-            } else {
-                pos[0] = pos[0] / 3.0;
-                pos[1] = pos[1] / 3.0;
-                pos[2] = pos[2] / 3.0;
-            }
-            v->pos = pos;
-            midPts[curr->id] = std::move(v);
-            curr = curr->next;
-        } while (curr != face->halfedge);
+// refreshes the smooth preview after the color of cage face f has changed
+void MyGL::updateSmoothFace(uint32_t f) {
+    if (!smoothPreview) {
+        return;
     }
+    // every refined face of f goes up in one batch
+    const std::vector<uint32_t> &start = m_smoothCache.refinedFaceStart(smoothLevel);
+    const std::vector<uint32_t> &refined = m_smoothCache.refinedFaces(smoothLevel);
+    std::vector<uint32_t> faces(refined.begin() + start[f], refined.begin() + start[f + 1]);
+    m_smoothMesh.recolorFaces(faces, m_mesh.faceColor[f]);
+    m_smoothMesh.update();
 }
 
-// get centroids of faces, used in subdivision
-void MyGL::computeCentroids() {
-    centroids.clear();
-    for (uPtr<Face> &face : m_mesh.faces) {
-        uPtr<Vertex> v = mkU<Vertex>();
-        glm::vec3 pos = glm::vec3(0.0, 0.0, 0.0);
-        HalfEdge *curr = face->halfedge;
-        int count = 0;
-        do {
-            pos += curr->vertex->pos;
-            curr = curr->next;
-            count += 1;
-        } while (curr != face->halfedge);
-        pos[0] = pos[0] / count;
-        pos[1] = pos[1] / count;
-        pos[2] = pos[2] / count;
-        v->pos = pos;
-        centroids[face->id] = std::move(v);
-    }
+// deselects everything, used when element ids change
+void MyGL::clearSelection() {
+    TRACE_SCOPE("MyGL::clearSelection");
+    selectedVertex = Vertex();
+    selectedEdge = HalfEdge();
+    selectedFace = Face();
+    vDisplay.updateVertex(Vertex());
+    eDisplay.updateEdge(HalfEdge());
+    fDisplay.updateFace(Face());
+    vDisplay.destroy();
+    vDisplay.create();
+    eDisplay.destroy();
+    eDisplay.create();
+    fDisplay.destroy();
+    fDisplay.create();
+}
+
+// keeps whatever is still selected after compaction, the displays
+// are rebuilt because the ids they show may have moved
+void MyGL::remapSelection(const MeshRemap &remap) {
+    selectedVertex = remap.apply(selectedVertex);
+    selectedEdge = remap.apply(selectedEdge);
+    selectedFace = remap.apply(selectedFace);
+    vDisplay.updateVertex(selectedVertex);
+    eDisplay.updateEdge(selectedEdge);
+    fDisplay.updateFace(selectedFace);
+    vDisplay.destroy();
+    vDisplay.create();
+    eDisplay.destroy();
+    eDisplay.create();
+    fDisplay.destroy();
+    fDisplay.create();
 }
 
 // slot for extruding edge
 void MyGL::slot_extrude() {
-    if (selectedFace != nullptr) {
-        int count = selectedFace->vertexCount();
-        std::vector<uPtr<HalfEdge>> vertEdges;
-        std::vector<uPtr<HalfEdge>> topEdges;
-        std::vector<uPtr<Vertex>> vertices;
-        HalfEdge *curr = selectedFace->halfedge;
-        HalfEdge *startEdge = selectedFace->halfedge;
-        glm::vec3 vec1 = glm::normalize(curr->next->vertex->pos - curr->vertex->pos);
-        glm::vec3 vec2 = glm::normalize(curr->next->next->vertex->pos - curr->next->vertex->pos);
-        glm::vec3 normal = glm::normalize(glm::cross(vec1, vec2));
-
-        // initialize new vertices and edges
-        for (int i = 0; i < count; i++) {
-            uPtr<HalfEdge> v1 = mkU<HalfEdge>();
-            uPtr<HalfEdge> v2 = mkU<HalfEdge>();
-            uPtr<HalfEdge> top = mkU<HalfEdge>();
-            uPtr<Vertex> v = mkU<Vertex>();
-            v->pos = glm::vec3(startEdge->vertex->pos) + normal;
-            startEdge = startEdge->next;
-            if (i != 0) {
-                v2->sym = vertEdges[(vertEdges.size()-2)].get();
-                vertEdges[vertEdges.size()-2]->sym = v2.get();
-            }
-            vertEdges.push_back(std::move(v1));
-            vertEdges.push_back(std::move(v2));
-            topEdges.push_back(std::move(top));
-            vertices.push_back(std::move(v));
-        }
-        vertEdges[1]->sym = vertEdges[vertEdges.size()-2].get();
-        vertEdges[vertEdges.size()-2]->sym = vertEdges[1].get();
-
-        // extrude each face
-        Vertex *startVertex = curr->sym->vertex;
-        for (int i = 0; i < count; i++) {
-            HalfEdge *HE1 = curr;
-            HalfEdge *HE2 = HE1->sym;
-            Vertex *v1 = HE1->vertex;
-            Vertex *v2 = HE2->vertex;
-            Vertex *v3 = vertices[i].get();
-            Vertex *v4 = vertices[(i-1) % vertices.size()].get();
-            uPtr<HalfEdge> HE1B = mkU<HalfEdge>();
-            HalfEdge *HE2B = topEdges[i].get();
-            HalfEdge *HE3 = vertEdges[i*2].get();
-            HalfEdge *HE4 = vertEdges[i*2+1].get();
-            uPtr<Face> f = mkU<Face>();
-            HE1->vertex = v3;
-            HE1->prevEdge()->vertex = v4;
-            HE1B->sym = HE1;
-            HE2B->sym = HE2;
-            HE1->sym = HE1B.get();
-            HE2->sym = HE2B;
-            HE1B->vertex = v4;
-            if (i == count - 1) {
-                HE2B->vertex = startVertex;
-            } else {
-                HE2B->vertex = v1;
-            }
-            HE1B->face = f.get();
-            HE2B->face = f.get();
-            HE3->face = f.get();
-            HE4->face = f.get();
-            HE3->vertex = v3;
-            HE4->vertex = v2;
-            HE1B->next = HE4;
-            HE4->next = HE2B;
-            HE2B->next = HE3;
-            HE3->next = HE1B.get();
-            f->halfedge = HE1B.get();
-            v3->halfedge = HE1;
-            v4->halfedge = HE2;
-            curr = curr->next;
-            emit sig_sendEdges(HE1B.get());
-            emit sig_sendFaces(f.get());
-            m_mesh.edges.push_back(std::move(HE1B));
-            m_mesh.faces.push_back(std::move(f));
+    if (selectedFace.isValid()) {
+        if (m_mesh.isBoundaryFace(selectedFace.index)) {
+            std::cerr << "Cannot extrude face " << selectedFace.index << ", it has a boundary edge" << std::endl;
+            return;
         }
-
+        PerfStats::Operation op(m_perfStats, "extrude");
+        emit sig_meshAboutToChange();
+        m_mesh.extrudeFace(selectedFace.index);
 
         // send signals to gui
-        for (uPtr<HalfEdge> &edge : vertEdges) {
-            emit sig_sendEdges(edge.get());
-            m_mesh.edges.push_back(std::move(edge));
-        }
-        for (uPtr<HalfEdge> &edge : topEdges) {
-            emit sig_sendEdges(edge.get());
-            m_mesh.edges.push_back(std::move(edge));
-        }
-        for (uPtr<Vertex> &vertex : vertices) {
-            emit sig_sendVertices(vertex.get());
-            m_mesh.vertices.push_back(std::move(vertex));
-        }
+        sendSignalsMesh();
         fDisplay.destroy();
         fDisplay.create();
-        m_mesh.destroy();
         m_mesh.create();
         this->update();
 
     }
 }
 
+// slot for deleting the current face
+void MyGL::slot_deleteFace() {
+    if (selectedFace.isValid()) {
+        PerfStats::Operation op(m_perfStats, "delete face");
+        emit sig_meshAboutToChange();
+        m_mesh.deleteFace(selectedFace.index);
+        // the lists, the draw buffers and the smooth preview expect dense ids
+        MeshRemap remap;
+        m_mesh.compact(&remap);
+        remapSelection(remap);
+
+        sendSignalsMesh();
+        m_mesh.create();
+        this->update();
+    }
+}
+
 // send signals of mesh
 void MyGL::sendSignalsMesh() {
-    for (uPtr<HalfEdge> &edge : m_mesh.edges) {
-        emit sig_sendEdges(edge.get());
-    }
-    for (uPtr<Face> &face : m_mesh.faces) {
-        emit sig_sendFaces(face.get());
-    }
-    for (uPtr<Vertex> &vertex : m_mesh.vertices) {
-        emit sig_sendVertices(vertex.get());
-    }
+    TRACE_SCOPE("MyGL::sendSignalsMesh");
+    // the cage topology changed, so the cached refinement levels are stale
+    m_smoothCache.invalidate();
+    updateSmoothMesh();
+    // the connected slots run inside the emit
+    TRACE_SCOPE("emit sig_meshChanged");
+    emit sig_meshChanged();
 }
 
 // slot for reading obj files
 void MyGL::slot_readObj() {
+    TRACE_SCOPE("MyGL::slot_readObj");
     QString filename = QFileDialog::getOpenFileName(0, QString("Load obj"), QDir::currentPath().append(QString("../..")), QString("*.obj"));
     QFile file(filename);
-    std::vector<glm::vec4> posVec;
-    std::map<std::pair<int, int>, HalfEdge*> symmap;
-    int faceCount = 0;
 
     // if file is valid
     if (file.exists()) {
-        m_mesh.edges.clear();
-        m_mesh.faces.clear();
-        m_mesh.vertices.clear();
-        if (file.open(QFile::ReadOnly | QFile::Text)) {
-            while (!file.atEnd()) {
-                QString line = file.readLine().trimmed();
-                QStringList lineParts = line.split(QRegularExpression("\\s+"));
-                // read through line
-                if (lineParts.count() > 0) {
-                    if (lineParts[0].compare("v", Qt::CaseInsensitive) == 0) {
-                        uPtr<Vertex> v = mkU<Vertex>();
-                        v->pos = glm::vec3(lineParts[1].toFloat(), lineParts[2].toFloat(), lineParts[3].toFloat());
-                        m_mesh.vertices.push_back(std::move(v));
-                    } else if (lineParts[0].compare("f", Qt::CaseInsensitive) == 0) {
-                        uPtr<Face> face = mkU<Face>();
-                        std::vector<uPtr<HalfEdge>> edges;
-                        std::vector<QStringList> stringLists;
-
-                        // initialize new edges
-                        for (int i = 1; i < lineParts.size(); i++) {
-                            uPtr<HalfEdge> e = mkU<HalfEdge>();
-                            QStringList segParts = lineParts[i].split("/");
-                            stringLists.push_back(segParts);
-                            e->vertex = m_mesh.vertices[segParts[0].toInt() - 1].get();
-                            m_mesh.vertices[segParts[0].toInt() - 1]->halfedge = e.get();
-                            edges.push_back(std::move(e));
-                        }
-                        int count = lineParts.size() - 1;
-
-                        // iterate through each face
-                        for (int i = 1; i < lineParts.size(); i++) {
-                            QStringList segParts = stringLists[i - 1];
-                            posVec.push_back(glm::vec4(m_mesh.vertices[segParts[0].toInt() - 1]->pos, 1));
-                            HalfEdge *edge = edges[i-1].get();
-                            edge->next = edges[(i) % count].get();
-                            edge->face = face.get();
-                            std::pair<int, int> sympair;
-                            std::pair<int, int> currpair;
-                            if (i == 1) {
-                                 sympair = std::make_pair(segParts[0].toInt() - 1, stringLists[count-1][0].toInt() - 1);
-                                 currpair = std::make_pair(stringLists[count-1][0].toInt()-1, segParts[0].toInt() - 1);
-                            } else {
-                                sympair = std::make_pair(segParts[0].toInt() - 1, stringLists[(i-2) % count][0].toInt() - 1);
-                                currpair = std::make_pair(stringLists[(i-2) % count][0].toInt()-1, segParts[0].toInt() - 1);
-                            }
-                            if (symmap.find(sympair) == symmap.end()) {
-                                symmap[currpair] = edge;
-                            } else {
-                                edge->sym = symmap[sympair];
-                                symmap[sympair]->sym = edge;
-                            }
-                        }
-
-                        // set halfedge of new face
-                        face->halfedge = edges[0].get();
-                        faceCount += lineParts.size() - 1;
-                        m_mesh.faces.push_back(std::move(face));
-                        for (uPtr<HalfEdge> &edge : edges) {
-                            m_mesh.edges.push_back(std::move(edge));
-                        }
-                    }
-                }
-            }
-            file.close();
-            m_mesh.destroy();
-            m_mesh.create();
-            sendSignalsMesh();
-            update();
+        PerfStats::Operation op(m_perfStats, "load obj");
+        // the current mesh stays on screen until the new one is complete
+        ObjData obj;
+        ObjReader reader(threadCount);
+        if (!reader.read(filename.toStdString(), obj)) {
+            std::cerr << "Failed to read " << filename.toStdString() << ": " << reader.error() << std::endl;
+            return;
+        }
+        HalfEdgeMesh loaded;
+        MeshBuildReport report;
+        if (!buildHalfEdgeMesh(obj, loaded, &report, threadCount)) {
+            std::cerr << "Failed to build a mesh from " << filename.toStdString() << std::endl;
+            return;
+        }
+        if (!report.nonManifoldEdges.empty()) {
+            std::cerr << report.nonManifoldEdges.size() << " non-manifold halfedges in "
+                      << filename.toStdString() << " were left unpaired" << std::endl;
         }
+        emit sig_meshAboutToChange();
+        m_mesh.swap(loaded);
+        // ids of the old mesh are gone, drop the selection
+        clearSelection();
+        m_mesh.create();
+        sendSignalsMesh();
+        update();
+    }
+}
+
+// slot for reading .hemesh files
+void MyGL::slot_readMesh() {
+    QString filename = QFileDialog::getOpenFileName(0, QString("Load mesh"), QDir::currentPath().append(QString("../..")), QString("*.hemesh"));
+    QFile file(filename);
+
+    // if file is valid
+    if (file.exists()) {
+        PerfStats::Operation op(m_perfStats, "load mesh");
+        // the current mesh stays on screen until the new one is complete
+        HalfEdgeMesh loaded;
+        HemeshFile reader(threadCount);
+        if (!reader.read(filename.toStdString(), loaded)) {
+            std::cerr << "Failed to read " << filename.toStdString() << ": " << reader.error() << std::endl;
+            return;
+        }
+        emit sig_meshAboutToChange();
+        m_mesh.swap(loaded);
+        // ids of the old mesh are gone, drop the selection
+        clearSelection();
+        m_mesh.create();
+        sendSignalsMesh();
+        update();
+    }
+}
+
+// slot for writing .hemesh files
+void MyGL::slot_writeMesh() {
+    QString filename = QFileDialog::getSaveFileName(0, QString("Save mesh"), QDir::currentPath().append(QString("../..")), QString("*.hemesh"));
+    if (filename.isEmpty()) {
+        return;
+    }
+    PerfStats::Operation op(m_perfStats, "save mesh");
+    HemeshFile writer(threadCount);
+    if (!writer.write(filename.toStdString(), m_mesh)) {
+        std::cerr << "Failed to write " << filename.toStdString() << ": " << writer.error() << std::endl;
+    }
+}
+
+// slot for exporting obj or ply files
+void MyGL::slot_exportMesh() {
+    QString filename = QFileDialog::getSaveFileName(0, QString("Export mesh"), QDir::currentPath().append(QString("../..")), QString("*.obj;;*.ply"));
+    if (filename.isEmpty()) {
+        return;
+    }
+    PerfStats::Operation op(m_perfStats, "export");
+    MeshWriter writer;
+    // vertices left without faces by editing are not written
+    writer.setCompact(true);
+    if (!writer.write(filename.toStdString(), m_mesh)) {
+        std::cerr << "Failed to write " << filename.toStdString() << ": " << writer.error() << std::endl;
     }
 }
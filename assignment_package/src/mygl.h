@@ -10,6 +10,8 @@
 #include <vertexdisplay.h>
 #include "halfedgedisplay.h"
 #include "facedisplay.h"
+#include "subdivisioncache.h"
+#include "perfstats.h"
 
 
 #include <QOpenGLVertexArrayObject>
@@ -23,15 +25,16 @@ class MyGL
 private:
     SquarePlane m_geomSquare;// The instance of a unit cylinder we can use to render any cylinder
     Mesh m_mesh;
+    Mesh m_smoothMesh; // m_mesh subdivided for the smooth preview
+    SubdivisionCache m_smoothCache; // refinement levels of m_mesh
     ShaderProgram m_progLambert;// A shader program that uses lambertian reflection
     ShaderProgram m_progFlat;// A shader program that uses "flat" reflection (no shadowing at all)
 
 
-    GLuint vao; // A handle for our vertex array object. This will store the VBOs created in our geometry classes.
-                // Don't worry too much about this. Just know it is necessary in order to render geometry.
-
     Camera m_glCamera;
 
+    PerfStats m_perfStats; // frame times and the last operation, for the HUD
+
 
 public:
     explicit MyGL(QWidget *parent = nullptr);
@@ -41,33 +44,37 @@ public:
     HalfEdgeDisplay eDisplay; // object for displaying a edge on gui
     FaceDisplay fDisplay; // object for displaying a face on gui
 
-    Vertex *selectedVertex; // currently selected vertex
-    HalfEdge *selectedEdge; // currently selected edge
-    Face *selectedFace; // currently selected face
+    Vertex selectedVertex; // currently selected vertex
+    HalfEdge selectedEdge; // currently selected edge
+    Face selectedFace; // currently selected face
+
+    int threadCount; // threads used by subdivision, 0 uses every core
+    bool smoothPreview; // draw the subdivided mesh instead of the cage
+    int smoothLevel; // subdivision level of the smooth preview
+
+    const HalfEdgeMesh &getMesh() const; // mesh being edited, for the gui lists
+    const PerfStats &perfStats(); // HUD counters, element counts and GL bytes brought up to date
 
     void initializeGL();
     void resizeGL(int w, int h);
     void paintGL();
-    void computeCentroids(); // get centroids of faces, used in subdivision
-    void computeMidPts(); // get midpoints of edges, used in subdivision
-    void smoothVertices(); // smooth vertices, used in subdivision
-    void splitByMidPt(HalfEdge*); // split by mid points, used in subdivision
-
-    std::map<int, uPtr<Vertex>> centroids; // stores centroids of faces
-    std::map<int, uPtr<Vertex>> midPts; // stores midpoints of edges
+    void clearSelection(); // deselects everything, used when element ids change
+    void remapSelection(const MeshRemap &remap); // follows the selection through HalfEdgeMesh::compact
+    void updateSmoothMesh(); // rebuilds the smooth preview from the cached levels
+    void updateSmoothVertex(uint32_t v); // refreshes the smooth preview after cage vertex v moved
+    void updateSmoothFace(uint32_t f); // refreshes the smooth preview after cage face f was recolored
 
 
 signals:
-    void sig_sendVertices(Vertex*); // send vertices to gui
-    void sig_sendEdges(HalfEdge*); // send edges to gui
-    void sig_sendFaces(Face*); // send faces to gui
+    void sig_meshAboutToChange(); // elements of the mesh are about to be added, removed or renumbered
+    void sig_meshChanged(); // elements of the mesh were added or replaced
 
 
 
 public slots:
-    void slot_vertexSelected(QListWidgetItem*); // slot for vertex selection
-    void slot_halfEdgeSelected(QListWidgetItem*); // slot for edge selection
-    void slot_faceSelected(QListWidgetItem*); // slot for face selection
+    void slot_vertexSelected(int); // slot for vertex selection
+    void slot_halfEdgeSelected(int); // slot for edge selection
+    void slot_faceSelected(int); // slot for face selection
 
     void slot_vertexTranslateX(double); // slot for vertex translation in x
     void slot_vertexTranslateY(double); // slot for vertex translation in y
@@ -81,7 +88,14 @@ public slots:
     void slot_triangulate(); // slot for triangulating the current face
     void slot_subdivide(); // slot for subdividing mesh
     void slot_extrude(); // slot for extruding edge
+    void slot_deleteFace(); // slot for deleting the current face
     void slot_readObj(); // slot for reading obj files
+    void slot_readMesh(); // slot for reading .hemesh files
+    void slot_writeMesh(); // slot for writing .hemesh files
+    void slot_exportMesh(); // slot for exporting obj or ply files
+    void slot_setThreadCount(int); // slot for the number of subdivision threads
+    void slot_setSmoothPreview(bool); // slot for toggling the smooth preview
+    void slot_setSmoothLevel(int); // slot for the level of the smooth preview
     void sendSignalsMesh(); // send signals of mesh
 
 protected:
@@ -0,0 +1,462 @@
+#include "objreader.h"
+#include "mappedfile.h"
+#include "parallel.h"
+#include "trace.h"
+#include <algorithm>
+#include <cstring>
+
+int ObjData::numFaces() const {
+    return faceStart.empty() ? 0 : int(faceStart.size() - 1);
+}
+
+void ObjData::clear() {
+    positions.clear();
+    texcoords.clear();
+    normals.clear();
+    faceStart.clear();
+    facePositions.clear();
+    faceTexcoords.clear();
+    faceNormals.clear();
+}
+
+namespace {
+
+// Records parsed from one contiguous range of lines.
+// Corner indices written as positive numbers are stored 0-based.
+// Negative ones are stored relative to the first element of this range
+// (possibly below it) and listed in the relative* arrays, so they can be
+// resolved once the number of elements before the range is known.
+struct ObjChunk
+{
+    std::vector<glm::vec3> positions;
+    std::vector<glm::vec2> texcoords;
+    std::vector<glm::vec3> normals;
+    std::vector<uint32_t> faceSizes; // corner count of every face
+    std::vector<uint32_t> cornerPos;
+    std::vector<uint32_t> cornerTex; // ObjData::NONE where missing
+    std::vector<uint32_t> cornerNor; // ObjData::NONE where missing
+    std::vector<uint32_t> relativePos; // corners whose index in cornerPos is relative
+    std::vector<uint32_t> relativeTex;
+    std::vector<uint32_t> relativeNor;
+    bool hasTex = false;
+    bool hasNor = false;
+    const char *errorAt = nullptr; // start of the first bad line
+    const char *errorWhat = nullptr; // what was wrong with it
+};
+
+inline bool isSpace(char c) {
+    return c == ' ' || c == '\t';
+}
+
+inline bool isLineEnd(char c) {
+    return c == '\n' || c == '\r';
+}
+
+inline bool isDigit(char c) {
+    return c >= '0' && c <= '9';
+}
+
+inline const char *skipSpaces(const char *p, const char *end) {
+    while (p < end && isSpace(*p)) {
+        p++;
+    }
+    return p;
+}
+
+// first character of the next line
+inline const char *nextLine(const char *p, const char *end) {
+    const char *eol = static_cast<const char*>(std::memchr(p, '\n', size_t(end - p)));
+    return eol ? eol + 1 : end;
+}
+
+// whether a token ended cleanly
+inline bool atDelimiter(const char *p, const char *end) {
+    return p == end || isSpace(*p) || isLineEnd(*p);
+}
+
+double powerOfTen(int exponent) {
+    static const double table[] = {
+        1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+        1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+    };
+    double result = 1.0;
+    while (exponent > 22) {
+        result *= 1e22;
+        exponent -= 22;
+    }
+    return result * table[exponent];
+}
+
+// decimal number with optional sign, fraction and exponent; nullptr if there is none.
+// Up to 19 significant digits are kept exactly, which is far beyond float precision.
+const char *parseFloat(const char *p, const char *end, float &out) {
+    bool negative = false;
+    if (p < end && (*p == '-' || *p == '+')) {
+        negative = *p == '-';
+        p++;
+    }
+    uint64_t mantissa = 0;
+    int digits = 0;
+    int exponent = 0;
+    bool any = false;
+    for (; p < end && isDigit(*p); p++) {
+        any = true;
+        if (digits < 19) {
+            mantissa = mantissa * 10 + uint64_t(*p - '0');
+            digits += mantissa != 0 ? 1 : 0;
+        } else {
+            exponent += 1;
+        }
+    }
+    if (p < end && *p == '.') {
+        p++;
+        for (; p < end && isDigit(*p); p++) {
+            any = true;
+            if (digits < 19) {
+                mantissa = mantissa * 10 + uint64_t(*p - '0');
+                digits += mantissa != 0 ? 1 : 0;
+                exponent -= 1;
+            }
+        }
+    }
+    if (!any) {
+        return nullptr;
+    }
+    if (p < end && (*p == 'e' || *p == 'E')) {
+        p++;
+        bool negativeExponent = false;
+        if (p < end && (*p == '-' || *p == '+')) {
+            negativeExponent = *p == '-';
+            p++;
+        }
+        if (p == end || !isDigit(*p)) {
+            return nullptr;
+        }
+        int e = 0;
+        for (; p < end && isDigit(*p); p++) {
+            if (e < 10000) {
+                e = e * 10 + (*p - '0');
+            }
+        }
+        exponent += negativeExponent ? -e : e;
+    }
+
+    double value = double(mantissa);
+    if (exponent < -308 - 19) {
+        value = 0.0;
+    } else if (exponent < 0) {
+        value /= powerOfTen(-exponent);
+    } else if (exponent > 0) {
+        value *= powerOfTen(exponent);
+    }
+    out = float(negative ? -value : value);
+    return p;
+}
+
+// signed integer index; nullptr if there is none
+const char *parseIndex(const char *p, const char *end, int64_t &out) {
+    bool negative = false;
+    if (p < end && (*p == '-' || *p == '+')) {
+        negative = *p == '-';
+        p++;
+    }
+    if (p == end || !isDigit(*p)) {
+        return nullptr;
+    }
+    int64_t value = 0;
+    for (; p < end && isDigit(*p); p++) {
+        if (value <= 0xFFFFFFFFll) {
+            value = value * 10 + (*p - '0');
+        }
+    }
+    out = negative ? -value : value;
+    return p;
+}
+
+// stores one corner index, see ObjChunk
+bool storeIndex(int64_t index, size_t count, std::vector<uint32_t> &corners, std::vector<uint32_t> &relative) {
+    if (index > 0) {
+        if (index > 0xFFFFFFFEll) {
+            return false;
+        }
+        corners.push_back(uint32_t(index - 1));
+    } else if (index < 0) {
+        int64_t local = int64_t(count) + index;
+        if (local < -0x7FFFFFFFll) {
+            return false;
+        }
+        relative.push_back(uint32_t(corners.size()));
+        corners.push_back(uint32_t(int32_t(local)));
+    } else {
+        // OBJ indices start at 1
+        return false;
+    }
+    return true;
+}
+
+// parses every line in [begin, end); stops at the first bad line
+void parseChunk(const char *begin, const char *end, ObjChunk &chunk) {
+    const char *line = begin;
+    while (line < end) {
+        const char *p = skipSpaces(line, end);
+        const char *next = nextLine(p, end);
+        if (p == end || isLineEnd(*p) || *p == '#') {
+            line = next;
+            continue;
+        }
+
+        const char *what = nullptr;
+        if (p + 1 < end && p[0] == 'v' && isSpace(p[1])) {
+            glm::vec3 pos;
+            for (int i = 0; i < 3 && !what; i++) {
+                p = parseFloat(skipSpaces(p + (i == 0 ? 1 : 0), end), end, pos[i]);
+                if (!p || !atDelimiter(p, end)) {
+                    what = "bad vertex position";
+                }
+            }
+            chunk.positions.push_back(pos);
+        } else if (p + 2 < end && p[0] == 'v' && p[1] == 't' && isSpace(p[2])) {
+            // u is required, v defaults to 0 and w is ignored
+            glm::vec2 uv(0.0f, 0.0f);
+            p = parseFloat(skipSpaces(p + 2, end), end, uv[0]);
+            if (!p || !atDelimiter(p, end)) {
+                what = "bad texture coordinate";
+            } else {
+                p = skipSpaces(p, end);
+                if (p < end && !isLineEnd(*p)) {
+                    p = parseFloat(p, end, uv[1]);
+                    if (!p || !atDelimiter(p, end)) {
+                        what = "bad texture coordinate";
+                    }
+                }
+            }
+            chunk.texcoords.push_back(uv);
+        } else if (p + 2 < end && p[0] == 'v' && p[1] == 'n' && isSpace(p[2])) {
+            glm::vec3 nor;
+            p += 2;
+            for (int i = 0; i < 3 && !what; i++) {
+                p = parseFloat(skipSpaces(p, end), end, nor[i]);
+                if (!p || !atDelimiter(p, end)) {
+                    what = "bad vertex normal";
+                }
+            }
+            chunk.normals.push_back(nor);
+        } else if (p + 1 < end && p[0] == 'f' && isSpace(p[1])) {
+            // corners are v, v/vt, v//vn or v/vt/vn
+            uint32_t corners = 0;
+            p = skipSpaces(p + 1, end);
+            while (p < end && !isLineEnd(*p) && !what) {
+                int64_t index;
+                p = parseIndex(p, end, index);
+                if (!p || !storeIndex(index, chunk.positions.size(), chunk.cornerPos, chunk.relativePos)) {
+                    what = "bad face index";
+                    break;
+                }
+                bool tex = false;
+                bool nor = false;
+                if (p < end && *p == '/') {
+                    p++;
+                    if (p < end && *p != '/') {
+                        p = parseIndex(p, end, index);
+                        if (!p || !storeIndex(index, chunk.texcoords.size(), chunk.cornerTex, chunk.relativeTex)) {
+                            what = "bad face texture index";
+                            break;
+                        }
+                        tex = true;
+                    }
+                    if (p < end && *p == '/') {
+                        p = parseIndex(p + 1, end, index);
+                        if (!p || !storeIndex(index, chunk.normals.size(), chunk.cornerNor, chunk.relativeNor)) {
+                            what = "bad face normal index";
+                            break;
+                        }
+                        nor = true;
+                    }
+                }
+                if (!tex) {
+                    chunk.cornerTex.push_back(ObjData::NONE);
+                }
+                if (!nor) {
+                    chunk.cornerNor.push_back(ObjData::NONE);
+                }
+                chunk.hasTex = chunk.hasTex || tex;
+                chunk.hasNor = chunk.hasNor || nor;
+                corners += 1;
+                if (!atDelimiter(p, end)) {
+                    what = "bad face index";
+                }
+                p = skipSpaces(p, end);
+            }
+            if (!what && corners < 3) {
+                what = "face with fewer than 3 vertices";
+            }
+            chunk.faceSizes.push_back(corners);
+        }
+        // other records (o, g, s, usemtl, mtllib, l, ...) are skipped
+
+        if (what) {
+            chunk.errorAt = line;
+            chunk.errorWhat = what;
+            return;
+        }
+        line = next;
+    }
+}
+
+// line number of a position in the text, only needed for error messages
+int lineNumber(const char *begin, const char *at) {
+    int line = 1;
+    for (const char *p = begin; p < at; p++) {
+        line += *p == '\n' ? 1 : 0;
+    }
+    return line;
+}
+
+// resolves the relative corners of a chunk whose elements start at offset,
+// then checks every index against the element count of the whole file
+bool resolveIndices(uint32_t *corners, size_t nCorners, const std::vector<uint32_t> &relative,
+                    size_t offset, size_t count) {
+    for (uint32_t slot : relative) {
+        int64_t index = int64_t(offset) + int32_t(corners[slot]);
+        if (index < 0) {
+            return false;
+        }
+        corners[slot] = uint32_t(index);
+    }
+    for (size_t i = 0; i < nCorners; i++) {
+        if (corners[i] != ObjData::NONE && corners[i] >= count) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// chunks are at least this many bytes, so small files parse on one thread
+const size_t chunkGrain = size_t(1) << 20;
+
+} // namespace
+
+ObjReader::ObjReader(int threads)
+    : threads(threads), message()
+{}
+
+void ObjReader::setThreads(int threads) {
+    this->threads = threads;
+}
+
+const std::string &ObjReader::error() const {
+    return message;
+}
+
+bool ObjReader::read(const std::string &path, ObjData &out) {
+    TRACE_SCOPE("ObjReader::read");
+    MappedFile file;
+    if (!file.open(path)) {
+        out.clear();
+        message = "cannot open " + path;
+        return false;
+    }
+    return parse(file.data(), file.data() + file.size(), out);
+}
+
+bool ObjReader::parse(const char *begin, const char *end, ObjData &out) {
+    out.clear();
+    message.clear();
+    size_t size = begin ? size_t(end - begin) : 0;
+
+    // cut the text into chunks at line boundaries
+    size_t maxChunks = std::max<size_t>(size / chunkGrain, 1);
+    int chunks = int(std::min<size_t>(size_t(resolveThreadCount(threads)), maxChunks));
+    std::vector<const char*> cuts(chunks + 1, end);
+    cuts[0] = begin;
+    for (int c = 1; c < chunks; c++) {
+        const char *cut = std::max(begin + size * size_t(c) / size_t(chunks), cuts[c - 1]);
+        cuts[c] = cut == begin || cut[-1] == '\n' ? cut : nextLine(cut, end);
+    }
+
+    std::vector<ObjChunk> parsed(chunks);
+    parallelChunks(chunks, chunks, [&](int c, int, int) {
+        TRACE_SCOPE("ObjReader parse chunk");
+        if (cuts[c] < cuts[c + 1]) {
+            parseChunk(cuts[c], cuts[c + 1], parsed[c]);
+        }
+    });
+
+    // chunks stop at their first bad line, so the first failed chunk has the first error
+    for (const ObjChunk &chunk : parsed) {
+        if (chunk.errorAt) {
+            message = "line " + std::to_string(lineNumber(begin, chunk.errorAt)) + ": " + chunk.errorWhat;
+            return false;
+        }
+    }
+
+    // where every chunk's elements go in the merged arrays
+    struct Offsets
+    {
+        size_t pos, tex, nor, face, corner;
+    };
+    std::vector<Offsets> offsets(chunks + 1);
+    offsets[0] = {0, 0, 0, 0, 0};
+    bool hasTex = false;
+    bool hasNor = false;
+    for (int c = 0; c < chunks; c++) {
+        const ObjChunk &chunk = parsed[c];
+        offsets[c + 1].pos = offsets[c].pos + chunk.positions.size();
+        offsets[c + 1].tex = offsets[c].tex + chunk.texcoords.size();
+        offsets[c + 1].nor = offsets[c].nor + chunk.normals.size();
+        offsets[c + 1].face = offsets[c].face + chunk.faceSizes.size();
+        offsets[c + 1].corner = offsets[c].corner + chunk.cornerPos.size();
+        hasTex = hasTex || chunk.hasTex;
+        hasNor = hasNor || chunk.hasNor;
+    }
+    const Offsets &total = offsets[chunks];
+    if (total.corner > size_t(ObjData::NONE)) {
+        message = "too many face corners";
+        return false;
+    }
+
+    out.positions.resize(total.pos);
+    out.texcoords.resize(total.tex);
+    out.normals.resize(total.nor);
+    out.faceStart.resize(total.face + 1);
+    out.facePositions.resize(total.corner);
+    out.faceTexcoords.resize(hasTex ? total.corner : 0);
+    out.faceNormals.resize(hasNor ? total.corner : 0);
+    out.faceStart[total.face] = uint32_t(total.corner);
+
+    // every chunk copies into its own slice, so the result does not depend on the thread count
+    std::vector<char> valid(chunks, 1);
+    parallelChunks(chunks, chunks, [&](int c, int, int) {
+        TRACE_SCOPE("ObjReader merge chunk");
+        const ObjChunk &chunk = parsed[c];
+        const Offsets &at = offsets[c];
+        std::copy(chunk.positions.begin(), chunk.positions.end(), out.positions.begin() + at.pos);
+        std::copy(chunk.texcoords.begin(), chunk.texcoords.end(), out.texcoords.begin() + at.tex);
+        std::copy(chunk.normals.begin(), chunk.normals.end(), out.normals.begin() + at.nor);
+        uint32_t corner = uint32_t(at.corner);
+        for (size_t f = 0; f < chunk.faceSizes.size(); f++) {
+            out.faceStart[at.face + f] = corner;
+            corner += chunk.faceSizes[f];
+        }
+
+        size_t nCorners = chunk.cornerPos.size();
+        std::copy(chunk.cornerPos.begin(), chunk.cornerPos.end(), out.facePositions.begin() + at.corner);
+        bool ok = resolveIndices(out.facePositions.data() + at.corner, nCorners, chunk.relativePos, at.pos, total.pos);
+        if (hasTex) {
+            std::copy(chunk.cornerTex.begin(), chunk.cornerTex.end(), out.faceTexcoords.begin() + at.corner);
+            ok = ok && resolveIndices(out.faceTexcoords.data() + at.corner, nCorners, chunk.relativeTex, at.tex, total.tex);
+        }
+        if (hasNor) {
+            std::copy(chunk.cornerNor.begin(), chunk.cornerNor.end(), out.faceNormals.begin() + at.corner);
+            ok = ok && resolveIndices(out.faceNormals.data() + at.corner, nCorners, chunk.relativeNor, at.nor, total.nor);
+        }
+        valid[c] = ok ? 1 : 0;
+    });
+
+    if (std::find(valid.begin(), valid.end(), 0) != valid.end()) {
+        out.clear();
+        message = "face index out of range";
+        return false;
+    }
+    return true;
+}
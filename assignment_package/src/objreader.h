@@ -0,0 +1,49 @@
+#pragma once
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Polygon soup read from an OBJ file.
+// Faces are stored in CSR form: the corners of face f are
+// [faceStart[f], faceStart[f + 1]) of the corner arrays. All indices
+// are resolved to 0-based indices, including negative (relative) ones.
+struct ObjData
+{
+    static constexpr uint32_t NONE = 0xFFFFFFFFu; // corner without a texcoord or normal
+
+    std::vector<glm::vec3> positions; // v records
+    std::vector<glm::vec2> texcoords; // vt records
+    std::vector<glm::vec3> normals; // vn records
+
+    std::vector<uint32_t> faceStart; // first corner of every face, plus the corner count
+    std::vector<uint32_t> facePositions; // position of every corner
+    std::vector<uint32_t> faceTexcoords; // texcoord of every corner, empty if the file has none
+    std::vector<uint32_t> faceNormals; // normal of every corner, empty if the file has none
+
+    int numFaces() const;
+    void clear();
+};
+
+// OBJ parser working directly on a memory mapped file.
+// Records are tokenized in place with no per-line allocations and
+// numbers are converted by hand; only v, vt, vn and f records are read.
+// Large files are cut into chunks at line boundaries that are parsed on
+// separate threads and merged in file order, so the result is the same
+// for any thread count.
+class ObjReader
+{
+public:
+    // threads <= 0 uses every core, 1 parses serially
+    ObjReader(int threads = 0);
+    void setThreads(int threads);
+
+    bool read(const std::string &path, ObjData &out); // false on failure, see error()
+    bool parse(const char *begin, const char *end, ObjData &out); // parses OBJ text in memory
+
+    const std::string &error() const; // what went wrong in the last read or parse
+
+private:
+    int threads; // requested thread count
+    std::string message; // last error
+};
@@ -9,8 +9,9 @@
 
 
 OpenGLContext::OpenGLContext(QWidget *parent)
-    : QOpenGLWidget(parent)
+    : QOpenGLWidget(parent), currentProgram(), currentVertexArray()
 {
+    resetStateCache();
 }
 
 OpenGLContext::~OpenGLContext()
@@ -72,6 +73,37 @@ void OpenGLContext::debugContextVersion()
     }
 }
 
+void OpenGLContext::useProgram(GLuint prog)
+{
+    if (prog != currentProgram) {
+        glUseProgram(prog);
+        currentProgram = prog;
+    }
+}
+
+void OpenGLContext::bindVertexArray(GLuint vao)
+{
+    if (vao != currentVertexArray) {
+        glBindVertexArray(vao);
+        currentVertexArray = vao;
+    }
+}
+
+void OpenGLContext::vertexArrayDeleted(GLuint vao)
+{
+    // deleting the bound vertex array reverts the binding to 0
+    if (vao == currentVertexArray) {
+        currentVertexArray = 0;
+    }
+}
+
+void OpenGLContext::resetStateCache()
+{
+    // no real handle is this large, so the next binds always go through
+    currentProgram = GLuint(-1);
+    currentVertexArray = GLuint(-1);
+}
+
 void OpenGLContext::printGLErrorLog()
 {
     GLenum error = glGetError();
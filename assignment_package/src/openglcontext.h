@@ -11,6 +11,9 @@ class OpenGLContext
 
 
 protected:
+    GLuint currentProgram; // program last passed to glUseProgram
+    GLuint currentVertexArray; // vertex array last passed to glBindVertexArray
+
     /*** AUTOMATIC TESTING: DO NOT MODIFY ***/
     /*** If true, save a test image and exit */
     /***/ bool autotesting;
@@ -24,6 +27,13 @@ public:
     void printLinkInfoLog(int prog);
     void printShaderInfoLog(int shader);
 
+    // Cache of the bound program and vertex array, so ShaderProgram and
+    // Drawable can skip binds that would not change anything.
+    void useProgram(GLuint prog);
+    void bindVertexArray(GLuint vao);
+    void vertexArrayDeleted(GLuint vao); // call after glDeleteVertexArrays
+    void resetStateCache(); // call when GL state may have changed behind the cache
+
 private slots:
     /*** AUTOMATIC TESTING: DO NOT MODIFY ***/
     /***/ void saveImageAndQuit();
@@ -0,0 +1,26 @@
+#include "packedvertex.h"
+#include <cmath>
+
+PackedVertex::PackedVertex()
+    : pos(), nor(0), col{0, 0, 0, 255}
+{}
+
+PackedVertex::PackedVertex(const glm::vec3 &pos, const glm::vec3 &nor, const glm::vec3 &col)
+    : pos(pos), nor(0), col{0, 0, 0, 255}
+{
+    // each component becomes a 10 bit two's complement value, w stays 0
+    glm::vec3 n = glm::clamp(nor, -1.0f, 1.0f);
+    for (int i = 0; i < 3; i++) {
+        int32_t value = int32_t(std::round(n[i] * 511.0f));
+        this->nor |= (uint32_t(value) & 0x3FFu) << (10 * i);
+    }
+    setColor(col);
+}
+
+void PackedVertex::setColor(const glm::vec3 &color) {
+    glm::vec3 c = glm::clamp(color, 0.0f, 1.0f);
+    for (int i = 0; i < 3; i++) {
+        col[i] = uint8_t(std::round(c[i] * 255.0f));
+    }
+    col[3] = 255;
+}
@@ -0,0 +1,17 @@
+#pragma once
+#include <glm/glm.hpp>
+#include <cstdint>
+
+// Compact vertex for the interleaved layout: 20 bytes per vertex instead
+// of 48 for three separate vec4 buffers. Plain integer types keep it
+// free of GL headers so buffers can be assembled without a context.
+struct PackedVertex
+{
+    glm::vec3 pos; // position, the shader fills in w = 1
+    uint32_t nor; // normal as signed normalized 10:10:10:2 (GL_INT_2_10_10_10_REV)
+    uint8_t col[4]; // color as normalized RGBA8
+
+    PackedVertex();
+    PackedVertex(const glm::vec3 &pos, const glm::vec3 &nor, const glm::vec3 &col);
+    void setColor(const glm::vec3 &color);
+};
@@ -0,0 +1,87 @@
+#pragma once
+#include "jobsystem.h"
+#include <algorithm>
+#include <vector>
+
+// Helpers for splitting index ranges across threads.
+// Ranges are cut into contiguous chunks with fixed boundaries, so work
+// that writes to disjoint slots produces the same result for any
+// thread count. The chunks run as tasks on the shared JobSystem pool.
+
+// number of threads to use for a requested count, <= 0 means the pool size
+inline int resolveThreadCount(int threads) {
+    return threads > 0 ? threads : JobSystem::threads();
+}
+
+// number of chunks [0, count) is split into, small ranges stay on one thread
+inline int chunkCount(int count, int threads, int grain = 4096) {
+    int chunks = std::min(resolveThreadCount(threads), (count + grain - 1) / grain);
+    return std::max(chunks, 1);
+}
+
+// first index of a chunk, chunk == chunks gives count
+inline int chunkBegin(int count, int chunks, int chunk) {
+    return int((long long)count * chunk / chunks);
+}
+
+template<typename F>
+struct ChunkJob
+{
+    F *fn;
+    int count;
+    int chunks;
+
+    static void run(void *context, int chunk) {
+        const ChunkJob &job = *static_cast<ChunkJob*>(context);
+        (*job.fn)(chunk, chunkBegin(job.count, job.chunks, chunk),
+                  chunkBegin(job.count, job.chunks, chunk + 1));
+    }
+};
+
+// runs fn(chunk, begin, end) for every chunk, one task per chunk
+template<typename F>
+void parallelChunks(int count, int chunks, F fn) {
+    if (chunks <= 1) {
+        fn(0, 0, count);
+        return;
+    }
+    ChunkJob<F> job{&fn, count, chunks};
+    JobSystem::Group group;
+    group.pending.store(chunks - 1);
+    JobSystem::submit(group, &ChunkJob<F>::run, &job, 1, chunks);
+    // the calling thread takes the first chunk
+    ChunkJob<F>::run(&job, 0);
+    JobSystem::wait(group);
+}
+
+// runs fn(i) for every i in [0, count)
+template<typename F>
+void parallelFor(int count, int threads, F fn) {
+    parallelChunks(count, chunkCount(count, threads), [&fn](int, int begin, int end) {
+        for (int i = begin; i < end; i++) {
+            fn(i);
+        }
+    });
+}
+
+// combines map(begin, end) over the chunks of [0, count), starting from
+// identity; partial results are combined in chunk order, so the result
+// only depends on the thread count through the chunk boundaries
+template<typename T, typename Map, typename Combine>
+T parallelReduce(int count, int threads, T identity, Map map, Combine combine) {
+    // wrapped, so a std::vector<bool> does not pack the chunks into shared words
+    struct Partial
+    {
+        T value;
+    };
+    int chunks = chunkCount(count, threads);
+    std::vector<Partial> partial(chunks, Partial{identity});
+    parallelChunks(count, chunks, [&](int chunk, int begin, int end) {
+        partial[chunk].value = map(begin, end);
+    });
+    T result = identity;
+    for (const Partial &p : partial) {
+        result = combine(result, p.value);
+    }
+    return result;
+}
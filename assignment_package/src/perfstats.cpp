@@ -0,0 +1,189 @@
+#include "perfstats.h"
+#include <algorithm>
+#include <cstring>
+#include <unordered_map>
+
+const double PerfStats::histogramEdges[PerfStats::histogramBins] = {1, 2, 4, 8, 16, 33, 66, 1e300};
+
+PerfStats::Operation::Operation(PerfStats &stats, const char *name)
+    : stats(stats), name(name), capture(), begin(Trace::now())
+{}
+
+PerfStats::Operation::~Operation() {
+    double ms = double(Trace::now() - begin) / 1e6;
+    std::vector<TraceEvent> events;
+    capture.finish(events);
+    stats.setOperation(name, ms, Trace::currentThread(), events);
+}
+
+PerfStats::PerfStats()
+    : frames(frameWindow, 0.0), frameNext(0), frameCount(0), operation(),
+      vertices(0), halfEdges(0), faces(0), buffers()
+{}
+
+void PerfStats::addFrame(double ms) {
+    frames[frameNext] = ms;
+    frameNext = (frameNext + 1) % frameWindow;
+    frameCount = std::min(frameCount + 1, int(frameWindow));
+}
+
+int PerfStats::numFrames() const {
+    return frameCount;
+}
+
+double PerfStats::frameMs(int age) const {
+    return frames[(frameNext - 1 - age + 2 * frameWindow) % frameWindow];
+}
+
+double PerfStats::averageFrameMs() const {
+    double sum = 0.0;
+    for (int i = 0; i < frameCount; i++) {
+        sum += frameMs(i);
+    }
+    return frameCount > 0 ? sum / frameCount : 0.0;
+}
+
+double PerfStats::maxFrameMs() const {
+    double most = 0.0;
+    for (int i = 0; i < frameCount; i++) {
+        most = std::max(most, frameMs(i));
+    }
+    return most;
+}
+
+std::vector<int> PerfStats::frameHistogram() const {
+    std::vector<int> bins(histogramBins, 0);
+    for (int i = 0; i < frameCount; i++) {
+        double ms = frameMs(i);
+        int bin = 0;
+        while (bin + 1 < histogramBins && ms >= histogramEdges[bin]) {
+            bin += 1;
+        }
+        bins[bin] += 1;
+    }
+    return bins;
+}
+
+void PerfStats::setOperation(const std::string &name, double ms, int thread, const std::vector<TraceEvent> &events) {
+    operation.name = name;
+    operation.ms = ms;
+    operation.phases.clear();
+
+    // an event is inside every scope of the operation's thread that spans
+    // it, and inside the enclosing scopes of its own thread. A thread's
+    // events are stored as they end, so of two equal spans the later one
+    // is the outer scope.
+    size_t n = events.size();
+    std::vector<size_t> order(n);
+    for (size_t i = 0; i < n; i++) {
+        order[i] = i;
+    }
+    // outer scopes before the scopes they contain: by begin, longest first,
+    // then the operation's thread, then the later event
+    std::sort(order.begin(), order.end(), [&events, thread](size_t a, size_t b) {
+        const TraceEvent &x = events[a];
+        const TraceEvent &y = events[b];
+        if (x.begin != y.begin) {
+            return x.begin < y.begin;
+        }
+        if (x.end != y.end) {
+            return x.end > y.end;
+        }
+        if ((x.thread == thread) != (y.thread == thread)) {
+            return x.thread == thread;
+        }
+        return a > b;
+    });
+
+    // scopes of a thread nest, so the open scopes of each thread form a
+    // stack whose ends shrink towards the top
+    std::unordered_map<int, std::vector<size_t>> open;
+    std::vector<int> depth(n, 0);
+    for (size_t i : order) {
+        const TraceEvent &e = events[i];
+        std::vector<size_t> &own = open[e.thread];
+        while (!own.empty() && events[own.back()].end < e.end) {
+            own.pop_back();
+        }
+        depth[i] = int(own.size());
+        if (e.thread != thread) {
+            std::vector<size_t> &outer = open[thread];
+            while (!outer.empty() && events[outer.back()].end < e.begin) {
+                outer.pop_back();
+            }
+            // the ones that also reach past the end of e span it
+            auto spans = std::partition_point(outer.begin(), outer.end(), [&](size_t c) {
+                return events[c].end >= e.end;
+            });
+            depth[i] += int(spans - outer.begin());
+        }
+        own.push_back(i);
+    }
+
+    // phase of every scope name, one table per depth
+    std::vector<std::unordered_map<std::string, size_t>> phaseOf;
+    // phases are listed in the order they first started
+    for (size_t i = 0; i < n; i++) {
+        order[i] = i;
+    }
+    std::stable_sort(order.begin(), order.end(), [&events](size_t a, size_t b) {
+        return events[a].begin < events[b].begin;
+    });
+    for (size_t i : order) {
+        const TraceEvent &e = events[i];
+        if (size_t(depth[i]) >= phaseOf.size()) {
+            phaseOf.resize(depth[i] + 1);
+        }
+        auto inserted = phaseOf[depth[i]].emplace(e.name, operation.phases.size());
+        if (inserted.second) {
+            operation.phases.push_back(Phase{e.name, 0.0, 0, depth[i]});
+        }
+        Phase &phase = operation.phases[inserted.first->second];
+        phase.ms += double(e.end - e.begin) / 1e6;
+        phase.calls += 1;
+    }
+}
+
+const PerfStats::OperationStats &PerfStats::lastOperation() const {
+    return operation;
+}
+
+void PerfStats::setElementCounts(int vertices, int halfEdges, int faces) {
+    this->vertices = vertices;
+    this->halfEdges = halfEdges;
+    this->faces = faces;
+}
+
+int PerfStats::numVertices() const {
+    return vertices;
+}
+
+int PerfStats::numHalfEdges() const {
+    return halfEdges;
+}
+
+int PerfStats::numFaces() const {
+    return faces;
+}
+
+void PerfStats::setBufferBytes(const std::string &drawable, size_t bytes) {
+    for (BufferUsage &usage : buffers) {
+        if (usage.drawable == drawable) {
+            usage.bytes = bytes;
+            return;
+        }
+    }
+    buffers.push_back(BufferUsage{drawable, bytes});
+}
+
+const std::vector<PerfStats::BufferUsage> &PerfStats::bufferUsage() const {
+    return buffers;
+}
+
+size_t PerfStats::totalBufferBytes() const {
+    size_t total = 0;
+    for (const BufferUsage &usage : buffers) {
+        total += usage.bytes;
+    }
+    return total;
+}
@@ -0,0 +1,89 @@
+#pragma once
+#include "trace.h"
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// Counters behind the performance HUD, also read by code through MyGL::perfStats().
+// Frame times go into a ring of the last frameWindow paintGL calls.
+// An Operation times one editing step and keeps the TRACE_SCOPE phases
+// that ran inside it, on any thread. Element counts and GL buffer sizes
+// are set by the owner whenever they are asked for.
+class PerfStats
+{
+public:
+    static const int frameWindow = 240; // frames kept for the histogram
+    static const int histogramBins = 8;
+    static const double histogramEdges[histogramBins]; // upper bound of each bin in ms, the last is unbounded
+
+    // time spent in one traced scope name during an operation
+    struct Phase
+    {
+        std::string name;
+        double ms; // summed over calls, so parallel chunks can add up to more than the wall time
+        int calls;
+        int depth; // 0 for scopes directly inside the operation
+    };
+
+    struct OperationStats
+    {
+        std::string name; // empty before the first operation
+        double ms = 0.0; // wall time
+        std::vector<Phase> phases; // in the order they first started
+    };
+
+    struct BufferUsage
+    {
+        std::string drawable;
+        size_t bytes;
+    };
+
+    // times the enclosing block as operation name, for use as a local
+    class Operation
+    {
+    public:
+        Operation(PerfStats &stats, const char *name);
+        ~Operation();
+
+        Operation(const Operation &) = delete;
+        Operation &operator=(const Operation &) = delete;
+
+    private:
+        PerfStats &stats;
+        const char *name;
+        TraceCapture capture;
+        int64_t begin;
+    };
+
+    PerfStats();
+
+    void addFrame(double ms); // CPU time of one paintGL call
+    int numFrames() const; // frames in the ring, at most frameWindow
+    double frameMs(int age) const; // 0 is the newest frame
+    double averageFrameMs() const;
+    double maxFrameMs() const;
+    std::vector<int> frameHistogram() const; // frames per bin of histogramEdges
+
+    // sums the events by scope name and nests them by time containment
+    void setOperation(const std::string &name, double ms, int thread, const std::vector<TraceEvent> &events);
+    const OperationStats &lastOperation() const;
+
+    void setElementCounts(int vertices, int halfEdges, int faces);
+    int numVertices() const;
+    int numHalfEdges() const;
+    int numFaces() const;
+
+    void setBufferBytes(const std::string &drawable, size_t bytes); // adds or replaces the entry
+    const std::vector<BufferUsage> &bufferUsage() const;
+    size_t totalBufferBytes() const;
+
+private:
+    std::vector<double> frames; // ring of frame times
+    int frameNext; // slot of the next frame
+    int frameCount; // valid slots
+    OperationStats operation;
+    int vertices;
+    int halfEdges;
+    int faces;
+    std::vector<BufferUsage> buffers;
+};
@@ -1,21 +1,48 @@
 #pragma once
 #include "smartpointerhelp.h"
-#include "face.h"
-#include "vertex.h"
-#include "halfedge.h"
+#include "halfedgemesh.h"
 #include "vector"
 #include "drawable.h"
 
-class Mesh : public Drawable
+// Half-edge mesh that draws itself.
+// Each face owns the contiguous run of VBO corners
+// [faceCornerStart[f], faceCornerStart[f + 1]), so edits that keep the
+// topology only re-upload the runs of the faces they touch. The
+// buffers are kept between uploads and only re-specified when the
+// topology changes. Color edits have their own queue that, in the
+// default layout, only writes bufCol.
+// setInterleaved(true) puts the corners into one interleaved buffer of
+// PackedVertex (20 bytes each) rather than three vec4 buffers. That
+// layout has no color-only buffer, so color edits then rewrite whole
+// corners; the default keeps the separate buffers.
+class Mesh : public Drawable, public HalfEdgeMesh
 {
 public:
     Mesh(OpenGLContext*);
     ~Mesh(); // destructor
     GLenum drawMode() override;
-    virtual void create() override;
-    void createCube(); // initializes cube structure
+    virtual void create() override; // uploads every face, reusing existing buffers
+    void setInterleaved(bool on); // picks the vertex layout, off by default, takes effect at the next create()
 
-    std::vector<uPtr<Face>> faces; // vector of faces
-    std::vector<uPtr<HalfEdge>> edges; // vector of edges
-    std::vector<uPtr<Vertex>> vertices; // vector of vertices
+    void markVertexDirty(uint32_t v); // faces around v need new positions and normals
+    void markFaceDirty(uint32_t f); // face needs every attribute rewritten
+    void markFaceColorDirty(uint32_t f); // face only needs its color rewritten
+    void recolorFaces(const std::vector<uint32_t> &faces, const glm::vec3 &color); // sets and queues colors
+    void update(); // uploads the dirty faces, or everything if the topology changed
+
+    uint32_t cornerStart(uint32_t f) const; // first VBO corner of a face as of the last upload
+    uint32_t cornerEnd(uint32_t f) const; // one past the last VBO corner of a face
+
+private:
+    bool interleaved; // one PackedVertex buffer instead of bufPos, bufNor and bufCol
+    std::vector<uint32_t> faceCornerStart; // first VBO corner of every face, plus the corner count
+    std::vector<uint32_t> dirtyFaces; // faces waiting to be uploaded
+    std::vector<bool> faceDirty; // whether a face is in dirtyFaces
+    std::vector<uint32_t> colorDirtyFaces; // faces waiting for a color upload
+    std::vector<bool> faceColorDirty; // whether a face is in colorDirtyFaces
+
+    bool layoutChanged() const; // the corner layout no longer matches the mesh
+    void uploadColors(); // uploads the colors of the faces in colorDirtyFaces
+    void writeFace(uint32_t face, glm::vec4 *pos, glm::vec4 *nor, glm::vec4 *col) const;
+    void writeFace(uint32_t face, PackedVertex *out) const;
 };
@@ -28,18 +28,15 @@ void SquarePlane::create()
     count = 6; // TODO: Set "count" to the number of indices in your index VBO
 
     generateIdx();
-    mp_context->glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, bufIdx);
-    mp_context->glBufferData(GL_ELEMENT_ARRAY_BUFFER, idx.size() * sizeof(GLuint), idx.data(), GL_STATIC_DRAW);
+    // binds our vertex array first, which records the index buffer
+    uploadIdx(idx.size() * sizeof(GLuint), idx.data(), GL_STATIC_DRAW);
 
     generatePos();
-    mp_context->glBindBuffer(GL_ARRAY_BUFFER, bufPos);
-    mp_context->glBufferData(GL_ARRAY_BUFFER, pos.size() * sizeof(glm::vec4), pos.data(), GL_STATIC_DRAW);
+    uploadPos(pos.size() * sizeof(glm::vec4), pos.data(), GL_STATIC_DRAW);
 
     generateNor();
-    mp_context->glBindBuffer(GL_ARRAY_BUFFER, bufNor);
-    mp_context->glBufferData(GL_ARRAY_BUFFER, nor.size() * sizeof(glm::vec4), nor.data(), GL_STATIC_DRAW);
+    uploadNor(nor.size() * sizeof(glm::vec4), nor.data(), GL_STATIC_DRAW);
 
     generateCol();
-    mp_context->glBindBuffer(GL_ARRAY_BUFFER, bufCol);
-    mp_context->glBufferData(GL_ARRAY_BUFFER, col.size() * sizeof(glm::vec4), col.data(), GL_STATIC_DRAW);
+    uploadCol(col.size() * sizeof(glm::vec4), col.data(), GL_STATIC_DRAW);
 }
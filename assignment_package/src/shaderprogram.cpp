@@ -1,15 +1,18 @@
 #include "shaderprogram.h"
+#include "trace.h"
 #include <QFile>
 #include <QStringBuilder>
 #include <iostream>
 #include <exception>
+#include <cstddef>
 
 
 ShaderProgram::ShaderProgram(OpenGLContext *context)
     : vertShader(), fragShader(), prog(),
       attrPos(-1), attrNor(-1), attrCol(-1),
       unifModel(-1), unifModelInvTr(-1), unifViewProj(-1), unifCamPos(-1),
-      context(context)
+      context(context), lastModel(), lastViewProj(), lastCamPos(),
+      hasModel(false), hasViewProj(false), hasCamPos(false)
 {}
 
 void ShaderProgram::create(const char *vertfile, const char *fragfile)
@@ -48,6 +51,10 @@ void ShaderProgram::create(const char *vertfile, const char *fragfile)
     // Tell prog that it manages these particular vertex and fragment shaders
     context->glAttachShader(prog, vertShader);
     context->glAttachShader(prog, fragShader);
+    // Fixed attribute locations let one vertex array per Drawable serve every program
+    context->glBindAttribLocation(prog, ATTR_POS, "vs_Pos");
+    context->glBindAttribLocation(prog, ATTR_NOR, "vs_Nor");
+    context->glBindAttribLocation(prog, ATTR_COL, "vs_Col");
     context->glLinkProgram(prog);
 
     // Check for linking success
@@ -68,15 +75,26 @@ void ShaderProgram::create(const char *vertfile, const char *fragfile)
     unifModelInvTr = context->glGetUniformLocation(prog, "u_ModelInvTr");
     unifViewProj   = context->glGetUniformLocation(prog, "u_ViewProj");
     unifCamPos      = context->glGetUniformLocation(prog, "u_CamPos");
+
+    // a new program has none of the cached uniform values
+    hasModel = false;
+    hasViewProj = false;
+    hasCamPos = false;
 }
 
 void ShaderProgram::useMe()
 {
-    context->glUseProgram(prog);
+    context->useProgram(prog);
 }
 
 void ShaderProgram::setModelMatrix(const glm::mat4 &model)
 {
+    // uniforms keep their values in the program, so an unchanged matrix is skipped
+    if (hasModel && model == lastModel) {
+        return;
+    }
+    hasModel = true;
+    lastModel = model;
     useMe();
 
     if (unifModel != -1) {
@@ -107,6 +125,11 @@ void ShaderProgram::setModelMatrix(const glm::mat4 &model)
 
 void ShaderProgram::setViewProjMatrix(const glm::mat4 &vp)
 {
+    if (hasViewProj && vp == lastViewProj) {
+        return;
+    }
+    hasViewProj = true;
+    lastViewProj = vp;
     // Tell OpenGL to use this shader program for subsequent function calls
     useMe();
 
@@ -125,6 +148,11 @@ void ShaderProgram::setViewProjMatrix(const glm::mat4 &vp)
 
 void ShaderProgram::setCamPos(glm::vec3 pos)
 {
+    if (hasCamPos && pos == lastCamPos) {
+        return;
+    }
+    hasCamPos = true;
+    lastCamPos = pos;
     useMe();
 
     if(unifCamPos != -1)
@@ -136,6 +164,8 @@ void ShaderProgram::setCamPos(glm::vec3 pos)
 //This function, as its name implies, uses the passed in GL widget
 void ShaderProgram::draw(Drawable &d)
 {
+    // GL runs asynchronously, so this measures the CPU side of the draw call
+    TRACE_SCOPE("ShaderProgram::draw");
     if(d.elemCount() < 0) {
         throw std::invalid_argument(
         "Attempting to draw a Drawable that has not initialized its count variable! Remember to set it to the length of your index array in create()."
@@ -143,39 +173,15 @@ void ShaderProgram::draw(Drawable &d)
     }
     useMe();
 
-    // Each of the following blocks checks that:
-    //   * This shader has this attribute, and
-    //   * This Drawable has a vertex buffer for this attribute.
-    // If so, it binds the appropriate buffers to each attribute.
-
-        // Remember, by calling bindPos(), we call
-        // glBindBuffer on the Drawable's VBO for vertex position,
-        // meaning that glVertexAttribPointer associates vs_Pos
-        // (referred to by attrPos) with that VBO
-    if (attrPos != -1 && d.bindPos()) {
-        context->glEnableVertexAttribArray(attrPos);
-        context->glVertexAttribPointer(attrPos, 4, GL_FLOAT, false, 0, nullptr);
-    }
-
-    if (attrNor != -1 && d.bindNor()) {
-        context->glEnableVertexAttribArray(attrNor);
-        context->glVertexAttribPointer(attrNor, 4, GL_FLOAT, false, 0, nullptr);
-    }
+    // The Drawable's vertex array remembers its buffers and attribute
+    // pointers. Every program binds vs_Pos, vs_Nor and vs_Col to the same
+    // locations (see create()), so after the first draw this is a single bind.
+    d.bindVertexArray();
 
-    if (attrCol != -1 && d.bindCol()) {
-        context->glEnableVertexAttribArray(attrCol);
-        context->glVertexAttribPointer(attrCol, 4, GL_FLOAT, false, 0, nullptr);
-    }
-
-    // Bind the index buffer and then draw shapes from it.
+    // Draw shapes from the index buffer recorded in the vertex array.
     // This invokes the shader program, which accesses the vertex buffers.
-    d.bindIdx();
     context->glDrawElements(d.drawMode(), d.elemCount(), GL_UNSIGNED_INT, 0);
 
-    if (attrPos != -1) context->glDisableVertexAttribArray(attrPos);
-    if (attrNor != -1) context->glDisableVertexAttribArray(attrNor);
-    if (attrCol != -1) context->glDisableVertexAttribArray(attrCol);
-
     context->printGLErrorLog();
 }
 
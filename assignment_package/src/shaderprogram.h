@@ -28,7 +28,7 @@ public:
     ShaderProgram(OpenGLContext* context);
     // Sets up the requisite GL data and shaders from the given .glsl files
     void create(const char *vertfile, const char *fragfile);
-    // Tells our OpenGL context to use this shader to draw things
+    // Tells our OpenGL context to use this shader to draw things, skipped if it already does
     void useMe();
     // Pass the given model matrix to this shader on the GPU
     void setModelMatrix(const glm::mat4 &model);
@@ -51,6 +51,14 @@ private:
     OpenGLContext* context;   // Since Qt's OpenGL support is done through classes like QOpenGLFunctions_3_2_Core,
                             // we need to pass our OpenGL context to the Drawable in order to call GL functions
                             // from within this class.
+
+    // Values last uploaded to the uniforms, so repeated uploads of the same value are skipped
+    glm::mat4 lastModel;
+    glm::mat4 lastViewProj;
+    glm::vec3 lastCamPos;
+    bool hasModel;
+    bool hasViewProj;
+    bool hasCamPos;
 };
 
 
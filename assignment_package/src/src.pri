@@ -2,15 +2,33 @@ INCLUDEPATH += $$PWD
 DEPENDPATH += $$PWD
 
 SOURCES += \
+    $$PWD/arena.cpp \
+    $$PWD/circulators.cpp \
     $$PWD/face.cpp \
     $$PWD/facedisplay.cpp \
+    $$PWD/generators.cpp \
     $$PWD/halfedge.cpp \
     $$PWD/halfedgedisplay.cpp \
+    $$PWD/halfedgemesh.cpp \
+    $$PWD/hemeshfile.cpp \
+    $$PWD/jobsystem.cpp \
     $$PWD/main.cpp \
     $$PWD/mainwindow.cpp \
+    $$PWD/mappedfile.cpp \
+    $$PWD/meshbuffers.cpp \
+    $$PWD/meshbuilder.cpp \
+    $$PWD/meshwriter.cpp \
+    $$PWD/meshlistmodel.cpp \
     $$PWD/mygl.cpp \
+    $$PWD/objreader.cpp \
+    $$PWD/packedvertex.cpp \
+    $$PWD/perfstats.cpp \
     $$PWD/scene/mesh.cpp \
     $$PWD/shaderprogram.cpp \
+    $$PWD/stenciltable.cpp \
+    $$PWD/subdivision.cpp \
+    $$PWD/subdivisioncache.cpp \
+    $$PWD/trace.cpp \
     $$PWD/utils.cpp \
     $$PWD/la.cpp \
     $$PWD/drawable.cpp \
@@ -22,15 +40,34 @@ SOURCES += \
     $$PWD/vertexdisplay.cpp
 
 HEADERS += \
+    $$PWD/arena.h \
+    $$PWD/circulators.h \
     $$PWD/face.h \
     $$PWD/facedisplay.h \
+    $$PWD/generators.h \
     $$PWD/halfedge.h \
     $$PWD/halfedgedisplay.h \
+    $$PWD/halfedgemesh.h \
+    $$PWD/hemeshfile.h \
+    $$PWD/jobsystem.h \
     $$PWD/la.h \
     $$PWD/mainwindow.h \
+    $$PWD/mappedfile.h \
+    $$PWD/meshbuffers.h \
+    $$PWD/meshbuilder.h \
+    $$PWD/meshwriter.h \
+    $$PWD/meshlistmodel.h \
     $$PWD/mygl.h \
+    $$PWD/objreader.h \
+    $$PWD/packedvertex.h \
+    $$PWD/perfstats.h \
+    $$PWD/parallel.h \
     $$PWD/scene/mesh.h \
     $$PWD/shaderprogram.h \
+    $$PWD/stenciltable.h \
+    $$PWD/subdivision.h \
+    $$PWD/subdivisioncache.h \
+    $$PWD/trace.h \
     $$PWD/utils.h \
     $$PWD/drawable.h \
     $$PWD/camera.h \
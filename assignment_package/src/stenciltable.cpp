@@ -0,0 +1,121 @@
+#include "stenciltable.h"
+#include "halfedgemesh.h"
+#include "subdivision.h"
+
+StencilTable::StencilTable()
+    : controlCount(0)
+{}
+
+int StencilTable::numStencils() const {
+    return offsets.empty() ? 0 : int(offsets.size() - 1);
+}
+
+int StencilTable::numControlVertices() const {
+    return controlCount;
+}
+
+bool StencilTable::isEmpty() const {
+    return numStencils() == 0;
+}
+
+void StencilTable::clear() {
+    offsets.clear();
+    indices.clear();
+    weights.clear();
+    influenceStart.clear();
+    influence.clear();
+    controlCount = 0;
+}
+
+void StencilTable::build(const HalfEdgeMesh &cage, int levels, HalfEdgeMesh &refined, int threads) {
+    int nVertices = cage.numVertices();
+    if (levels <= 0) {
+        // level 0 is the cage itself
+        refined = cage;
+        assign(nVertices, nVertices, threads, [](int r, Terms &terms) {
+            terms.emplace_back(uint32_t(r), 1.0f);
+        });
+    } else {
+        {
+            CatmullClark first(cage, threads);
+            first.refineTopology(refined);
+            first.refineStencils(*this);
+        }
+        // every further level maps onto the previous one, composing keeps the rows over the cage
+        for (int level = 1; level < levels; level++) {
+            HalfEdgeMesh finer;
+            StencilTable step;
+            CatmullClark cc(refined, threads);
+            cc.refineTopology(finer);
+            cc.refineStencils(step);
+            step.compose(*this, threads);
+            std::swap(offsets, step.offsets);
+            std::swap(indices, step.indices);
+            std::swap(weights, step.weights);
+            refined.swap(finer);
+        }
+        controlCount = nVertices;
+    }
+    evaluate(cage.vertPos, refined.vertPos, threads);
+    buildInfluence();
+}
+
+void StencilTable::evaluate(const std::vector<glm::vec3> &controlPos, std::vector<glm::vec3> &out, int threads) const {
+    out.resize(numStencils());
+    parallelFor(numStencils(), threads, [&](int r) {
+        glm::vec3 pos = glm::vec3(0.0, 0.0, 0.0);
+        for (uint32_t k = offsets[r]; k < offsets[r + 1]; k++) {
+            pos += weights[k] * controlPos[indices[k]];
+        }
+        out[r] = pos;
+    });
+}
+
+// sums in the same order as evaluate(), so both give identical positions
+void StencilTable::evaluateAffected(uint32_t control, const std::vector<glm::vec3> &controlPos,
+                                    std::vector<glm::vec3> &out) const {
+    for (uint32_t i = influenceStart[control]; i < influenceStart[control + 1]; i++) {
+        uint32_t r = influence[i];
+        glm::vec3 pos = glm::vec3(0.0, 0.0, 0.0);
+        for (uint32_t k = offsets[r]; k < offsets[r + 1]; k++) {
+            pos += weights[k] * controlPos[indices[k]];
+        }
+        out[r] = pos;
+    }
+}
+
+void StencilTable::compose(const StencilTable &coarse, int threads) {
+    StencilTable fine;
+    fine.offsets.swap(offsets);
+    fine.indices.swap(indices);
+    fine.weights.swap(weights);
+    assign(fine.numStencils(), coarse.numControlVertices(), threads,
+           [&](int r, Terms &terms) {
+        for (uint32_t k = fine.offsets[r]; k < fine.offsets[r + 1]; k++) {
+            uint32_t row = fine.indices[k];
+            float w = fine.weights[k];
+            for (uint32_t c = coarse.offsets[row]; c < coarse.offsets[row + 1]; c++) {
+                terms.emplace_back(coarse.indices[c], w * coarse.weights[c]);
+            }
+        }
+    });
+}
+
+// transposes the table; rows come out sorted since they are visited in order
+void StencilTable::buildInfluence() {
+    int nStencils = numStencils();
+    influenceStart.assign(controlCount + 1, 0);
+    for (uint32_t c : indices) {
+        influenceStart[c + 1] += 1;
+    }
+    for (int c = 0; c < controlCount; c++) {
+        influenceStart[c + 1] += influenceStart[c];
+    }
+    influence.resize(indices.size());
+    std::vector<uint32_t> fill(influenceStart.begin(), influenceStart.end() - 1);
+    for (int r = 0; r < nStencils; r++) {
+        for (uint32_t k = offsets[r]; k < offsets[r + 1]; k++) {
+            influence[fill[indices[k]]++] = uint32_t(r);
+        }
+    }
+}
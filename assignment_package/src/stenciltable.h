@@ -0,0 +1,108 @@
+#pragma once
+#include <glm/glm.hpp>
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+#include <vector>
+#include "arena.h"
+#include "parallel.h"
+
+class HalfEdgeMesh;
+
+// Sparse weights from control (cage) vertices to refined vertices.
+// Row r lists the control vertices that refined vertex r depends on,
+// so refined positions are re-evaluated as a weighted sum instead of
+// rebuilding the subdivided mesh. Rows are stored in CSR form: the
+// terms of row r are [offsets[r], offsets[r + 1]) of indices/weights,
+// sorted by control vertex.
+class StencilTable
+{
+public:
+    typedef std::pair<uint32_t, float> Term; // (control, weight)
+    typedef ArenaVector<Term> Terms; // terms of one row while it is built, in the thread's scratch arena
+
+    StencilTable();
+
+    std::vector<uint32_t> offsets; // start of each row, numStencils() + 1 entries
+    std::vector<uint32_t> indices; // control vertex of every term
+    std::vector<float> weights; // weight of every term
+
+    // rows that use each control vertex, in CSR form
+    std::vector<uint32_t> influenceStart;
+    std::vector<uint32_t> influence;
+
+    int numStencils() const; // number of refined vertices
+    int numControlVertices() const;
+    bool isEmpty() const;
+    void clear();
+    void buildInfluence(); // fills influenceStart/influence, needed by evaluateAffected
+
+    // subdivides cage `levels` times with Catmull-Clark, writes the refined
+    // topology into refined and the stencils of its vertices into this table
+    void build(const HalfEdgeMesh &cage, int levels, HalfEdgeMesh &refined, int threads = 0);
+
+    // refined positions for the given control positions
+    void evaluate(const std::vector<glm::vec3> &controlPos, std::vector<glm::vec3> &out, int threads = 0) const;
+    // re-evaluates only the rows that use one control vertex
+    void evaluateAffected(uint32_t control, const std::vector<glm::vec3> &controlPos,
+                          std::vector<glm::vec3> &out) const;
+
+    // replaces the rows over coarse's refined vertices with rows over its control vertices
+    void compose(const StencilTable &coarse, int threads = 0);
+
+    // fills rows [0, count) with fn(row, Terms &terms), where fn appends (control, weight)
+    // terms in any order; terms of the same control vertex are merged
+    template<typename F>
+    void assign(int count, int controls, int threads, F fn);
+
+private:
+    int controlCount; // number of control vertices
+};
+
+template<typename F>
+void StencilTable::assign(int count, int controls, int threads, F fn) {
+    controlCount = controls;
+    offsets.assign(count + 1, 0);
+    influenceStart.clear();
+    influence.clear();
+
+    // every chunk packs its rows on its own, then the chunks are concatenated
+    int chunks = chunkCount(count, threads, 1024);
+    std::vector<std::vector<uint32_t>> chunkIndices(chunks);
+    std::vector<std::vector<float>> chunkWeights(chunks);
+    parallelChunks(count, chunks, [&](int chunk, int begin, int end) {
+        // scratch of the thread running the chunk
+        ScratchScope scratch;
+        Terms terms(scratch.allocator<Term>());
+        std::vector<uint32_t> &idx = chunkIndices[chunk];
+        std::vector<float> &wgt = chunkWeights[chunk];
+        for (int r = begin; r < end; r++) {
+            terms.clear();
+            fn(r, terms);
+            // stable so equal controls are summed in the order they were added
+            std::stable_sort(terms.begin(), terms.end(), [](const Term &a, const Term &b) {
+                return a.first < b.first;
+            });
+            size_t rowStart = idx.size();
+            for (const Term &t : terms) {
+                if (idx.size() > rowStart && idx.back() == t.first) {
+                    wgt.back() += t.second;
+                } else {
+                    idx.push_back(t.first);
+                    wgt.push_back(t.second);
+                }
+            }
+            offsets[r + 1] = uint32_t(idx.size() - rowStart);
+        }
+    });
+    for (int r = 0; r < count; r++) {
+        offsets[r + 1] += offsets[r];
+    }
+
+    indices.resize(offsets[count]);
+    weights.resize(offsets[count]);
+    parallelChunks(count, chunks, [&](int chunk, int begin, int) {
+        std::copy(chunkIndices[chunk].begin(), chunkIndices[chunk].end(), indices.begin() + offsets[begin]);
+        std::copy(chunkWeights[chunk].begin(), chunkWeights[chunk].end(), weights.begin() + offsets[begin]);
+    });
+}
@@ -0,0 +1,338 @@
+#include "subdivision.h"
+#include "circulators.h"
+#include "parallel.h"
+#include "trace.h"
+#include <atomic>
+
+CatmullClark::CatmullClark(const HalfEdgeMesh &mesh, int threads)
+    : mesh(mesh), threads(threads), scratch(),
+      prev(scratch.allocator<uint32_t>()), edgeOf(scratch.allocator<uint32_t>()),
+      edgeHalfEdge(scratch.allocator<uint32_t>()), incidentStart(scratch.allocator<uint32_t>()),
+      incident(scratch.allocator<uint32_t>())
+{
+    TRACE_SCOPE("CatmullClark::CatmullClark");
+    int nHalfEdges = mesh.numHalfEdges();
+    prev.resize(nHalfEdges);
+    computePrevHalfEdges(mesh, prev.data(), threads);
+    numberEdges();
+    groupIncident();
+}
+
+// an edge is numbered by the first of its two halfedges, in halfedge order
+void CatmullClark::numberEdges() {
+    TRACE_SCOPE("CatmullClark::numberEdges");
+    const uint32_t NONE = HalfEdgeMesh::NONE;
+    int nHalfEdges = mesh.numHalfEdges();
+    edgeOf.resize(nHalfEdges);
+    auto isFirst = [this, NONE](uint32_t h) {
+        uint32_t sym = mesh.heSym[h];
+        return sym == NONE || h < sym;
+    };
+
+    // count the edges of every chunk, then give each chunk its id range
+    int chunks = chunkCount(nHalfEdges, threads);
+    std::vector<uint32_t> chunkFirst(chunks + 1, 0);
+    parallelChunks(nHalfEdges, chunks, [&](int chunk, int begin, int end) {
+        uint32_t count = 0;
+        for (int h = begin; h < end; h++) {
+            count += isFirst(h) ? 1 : 0;
+        }
+        chunkFirst[chunk + 1] = count;
+    });
+    for (int c = 0; c < chunks; c++) {
+        chunkFirst[c + 1] += chunkFirst[c];
+    }
+
+    edgeHalfEdge.resize(chunkFirst[chunks]);
+    parallelChunks(nHalfEdges, chunks, [&](int chunk, int begin, int end) {
+        uint32_t id = chunkFirst[chunk];
+        for (int h = begin; h < end; h++) {
+            if (isFirst(h)) {
+                edgeOf[h] = id;
+                edgeHalfEdge[id] = uint32_t(h);
+                id += 1;
+            }
+        }
+    });
+    parallelFor(nHalfEdges, threads, [&](int h) {
+        if (!isFirst(h)) {
+            edgeOf[h] = edgeOf[mesh.heSym[h]];
+        }
+    });
+}
+
+// buckets the halfedges by the vertex they point to
+void CatmullClark::groupIncident() {
+    TRACE_SCOPE("CatmullClark::groupIncident");
+    int nVertices = mesh.numVertices();
+    int nHalfEdges = mesh.numHalfEdges();
+    ArenaVector<std::atomic<uint32_t>> fill(nVertices, scratch.allocator<std::atomic<uint32_t>>());
+    parallelFor(nHalfEdges, threads, [&](int h) {
+        fill[mesh.heVertex[h]].fetch_add(1, std::memory_order_relaxed);
+    });
+
+    incidentStart.resize(nVertices + 1);
+    incidentStart[0] = 0;
+    for (int v = 0; v < nVertices; v++) {
+        incidentStart[v + 1] = incidentStart[v] + fill[v].load(std::memory_order_relaxed);
+    }
+
+    incident.resize(nHalfEdges);
+    parallelFor(nHalfEdges, threads, [&](int h) {
+        uint32_t v = mesh.heVertex[h];
+        uint32_t slot = fill[v].fetch_sub(1, std::memory_order_relaxed) - 1;
+        incident[incidentStart[v] + slot] = uint32_t(h);
+    });
+    // threads fill the buckets in any order, sorting fixes the summation order
+    parallelFor(nVertices, threads, [&](int v) {
+        std::sort(incident.begin() + incidentStart[v], incident.begin() + incidentStart[v + 1]);
+    });
+}
+
+int CatmullClark::numEdges() const {
+    return int(edgeHalfEdge.size());
+}
+
+void CatmullClark::refine(HalfEdgeMesh &out) const {
+    refineTopology(out);
+    refinePositions(mesh.vertPos, out.vertPos);
+}
+
+void CatmullClark::refineTopology(HalfEdgeMesh &out) const {
+    TRACE_SCOPE("CatmullClark::refineTopology");
+    const uint32_t NONE = HalfEdgeMesh::NONE;
+    uint32_t nVertices = uint32_t(mesh.numVertices());
+    uint32_t nEdges = uint32_t(numEdges());
+    uint32_t nFaces = uint32_t(mesh.numFaces());
+    uint32_t nHalfEdges = uint32_t(mesh.numHalfEdges());
+    uint32_t edgeBase = nVertices;
+    uint32_t faceBase = nVertices + nEdges;
+
+    // every element of out is known up front, so the threads below only
+    // write into ranges reserved here
+    out.clear();
+    out.addHalfEdges(4 * nHalfEdges);
+    out.addVertices(nVertices + nEdges + nFaces);
+    out.addFaces(nHalfEdges);
+
+    // the quad of halfedge h (u -> v, followed by v -> w) is
+    //   4h   : edge point of uv -> v
+    //   4h+1 : v -> edge point of vw
+    //   4h+2 : edge point of vw -> face point
+    //   4h+3 : face point -> edge point of uv
+    // so every input halfedge owns four fixed output slots
+    parallelFor(int(nHalfEdges), threads, [&](int i) {
+        uint32_t h = uint32_t(i);
+        uint32_t face = mesh.heFace[h];
+        uint32_t next = mesh.heNext[h];
+        uint32_t sym = mesh.heSym[h];
+        uint32_t nextSym = mesh.heSym[next];
+        uint32_t q = 4 * h;
+
+        out.heNext[q] = q + 1;
+        out.heNext[q + 1] = q + 2;
+        out.heNext[q + 2] = q + 3;
+        out.heNext[q + 3] = q;
+
+        out.heVertex[q] = mesh.heVertex[h];
+        out.heVertex[q + 1] = edgeBase + edgeOf[next];
+        out.heVertex[q + 2] = faceBase + face;
+        out.heVertex[q + 3] = edgeBase + edgeOf[h];
+
+        out.heSym[q] = sym == NONE ? NONE : 4 * prev[sym] + 1;
+        out.heSym[q + 1] = nextSym == NONE ? NONE : 4 * nextSym;
+        out.heSym[q + 2] = 4 * next + 3;
+        out.heSym[q + 3] = 4 * prev[h] + 2;
+
+        out.heFace[q] = h;
+        out.heFace[q + 1] = h;
+        out.heFace[q + 2] = h;
+        out.heFace[q + 3] = h;
+
+        // quads keep the color of the face they came from
+        out.faceHalfEdge[h] = q;
+        out.faceColor[h] = mesh.faceColor[face];
+    });
+
+    parallelFor(int(nVertices), threads, [&](int v) {
+        uint32_t he = mesh.vertHalfEdge[v];
+        out.vertHalfEdge[v] = he == NONE ? NONE : 4 * he;
+    });
+    parallelFor(int(nEdges), threads, [&](int e) {
+        out.vertHalfEdge[edgeBase + e] = 4 * edgeHalfEdge[e] + 3;
+    });
+    parallelFor(int(nFaces), threads, [&](int f) {
+        out.vertHalfEdge[faceBase + f] = 4 * mesh.faceHalfEdge[f] + 2;
+    });
+}
+
+void CatmullClark::refinePositions(const std::vector<glm::vec3> &cagePos, std::vector<glm::vec3> &out) const {
+    out.resize(mesh.numVertices() + numEdges() + mesh.numFaces());
+    // edge points use face points and vertex points use both
+    computeFacePoints(cagePos, out);
+    computeEdgePoints(cagePos, out);
+    computeVertexPoints(cagePos, out);
+}
+
+// face points are the centroids of the faces
+void CatmullClark::computeFacePoints(const std::vector<glm::vec3> &cagePos, std::vector<glm::vec3> &out) const {
+    TRACE_SCOPE("CatmullClark::computeFacePoints");
+    uint32_t faceBase = uint32_t(mesh.numVertices() + numEdges());
+    parallelFor(mesh.numFaces(), threads, [&](int f) {
+        glm::vec3 pos = glm::vec3(0.0, 0.0, 0.0);
+        uint32_t start = mesh.faceHalfEdge[f];
+        uint32_t curr = start;
+        int count = 0;
+        do {
+            pos += cagePos[mesh.heVertex[curr]];
+            curr = mesh.heNext[curr];
+            count += 1;
+        } while (curr != start);
+        out[faceBase + f] = pos / float(count);
+    });
+}
+
+// edge points average the endpoints and the two adjacent face points,
+// boundary edges use their midpoint
+void CatmullClark::computeEdgePoints(const std::vector<glm::vec3> &cagePos, std::vector<glm::vec3> &out) const {
+    TRACE_SCOPE("CatmullClark::computeEdgePoints");
+    uint32_t edgeBase = uint32_t(mesh.numVertices());
+    uint32_t faceBase = uint32_t(mesh.numVertices() + numEdges());
+    parallelFor(numEdges(), threads, [&](int e) {
+        uint32_t h = edgeHalfEdge[e];
+        uint32_t sym = mesh.heSym[h];
+        glm::vec3 pos = cagePos[mesh.heVertex[h]] + cagePos[mesh.heVertex[prev[h]]];
+        if (sym != HalfEdgeMesh::NONE) {
+            pos += out[faceBase + mesh.heFace[h]];
+            pos += out[faceBase + mesh.heFace[sym]];
+            out[edgeBase + e] = pos / 4.0f;
+        } else {
+            out[edgeBase + e] = pos / 2.0f;
+        }
+    });
+}
+
+// interior vertices move to
+//   (n - 2) / n * v + sum(edge points) / n^2 + sum(face points) / n^2
+// boundary vertices to (prev + 6 v + next) / 8 along the boundary
+void CatmullClark::computeVertexPoints(const std::vector<glm::vec3> &cagePos, std::vector<glm::vec3> &out) const {
+    TRACE_SCOPE("CatmullClark::computeVertexPoints");
+    const uint32_t NONE = HalfEdgeMesh::NONE;
+    uint32_t edgeBase = uint32_t(mesh.numVertices());
+    uint32_t faceBase = uint32_t(mesh.numVertices() + numEdges());
+
+    parallelFor(mesh.numVertices(), threads, [&](int v) {
+        glm::vec3 sumE = glm::vec3(0.0, 0.0, 0.0);
+        glm::vec3 sumF = glm::vec3(0.0, 0.0, 0.0);
+        glm::vec3 sumBoundary = glm::vec3(0.0, 0.0, 0.0);
+        int boundaryCount = 0;
+
+        // halfedges pointing to v; the halfedge after each one leaves v
+        for (uint32_t k = incidentStart[v]; k < incidentStart[v + 1]; k++) {
+            uint32_t h = incident[k];
+            uint32_t next = mesh.heNext[h];
+            sumE += out[edgeBase + edgeOf[h]];
+            sumF += out[faceBase + mesh.heFace[h]];
+            if (mesh.heSym[h] == NONE) {
+                sumBoundary += cagePos[mesh.heVertex[prev[h]]];
+                boundaryCount += 1;
+            }
+            if (mesh.heSym[next] == NONE) {
+                sumBoundary += cagePos[mesh.heVertex[next]];
+                boundaryCount += 1;
+            }
+        }
+
+        const glm::vec3 &pos = cagePos[v];
+        int n = int(incidentStart[v + 1] - incidentStart[v]);
+        if (boundaryCount == 2) {
+            out[v] = (sumBoundary + 6.0f * pos) / 8.0f;
+        } else if (boundaryCount == 0 && n > 0) {
+            out[v] = pos * float(n - 2) / float(n) +
+                     sumE / float(n * n) +
+                     sumF / float(n * n);
+        } else {
+            // isolated or non-manifold vertices stay in place
+            out[v] = pos;
+        }
+    });
+}
+
+void CatmullClark::refineStencils(StencilTable &out) const {
+    typedef StencilTable::Terms Terms;
+    const uint32_t NONE = HalfEdgeMesh::NONE;
+    int nVertices = mesh.numVertices();
+    int nEdges = numEdges();
+    int nFaces = mesh.numFaces();
+
+    // the face point of f, scaled by w
+    auto addFace = [this](Terms &terms, uint32_t f, float w) {
+        uint32_t start = mesh.faceHalfEdge[f];
+        uint32_t curr = start;
+        int count = 0;
+        do {
+            count += 1;
+            curr = mesh.heNext[curr];
+        } while (curr != start);
+        do {
+            terms.emplace_back(mesh.heVertex[curr], w / float(count));
+            curr = mesh.heNext[curr];
+        } while (curr != start);
+    };
+    // the edge point of edge e, scaled by w
+    auto addEdge = [this, &addFace, NONE](Terms &terms, uint32_t e, float w) {
+        uint32_t h = edgeHalfEdge[e];
+        uint32_t sym = mesh.heSym[h];
+        float endpoint = sym != NONE ? w / 4.0f : w / 2.0f;
+        terms.emplace_back(mesh.heVertex[h], endpoint);
+        terms.emplace_back(mesh.heVertex[prev[h]], endpoint);
+        if (sym != NONE) {
+            addFace(terms, mesh.heFace[h], w / 4.0f);
+            addFace(terms, mesh.heFace[sym], w / 4.0f);
+        }
+    };
+
+    out.assign(nVertices + nEdges + nFaces, nVertices, threads, [&](int r, Terms &terms) {
+        if (r >= nVertices + nEdges) {
+            addFace(terms, uint32_t(r - nVertices - nEdges), 1.0f);
+            return;
+        }
+        if (r >= nVertices) {
+            addEdge(terms, uint32_t(r - nVertices), 1.0f);
+            return;
+        }
+
+        // vertex point, classified the same way as in computeVertexPoints
+        uint32_t v = uint32_t(r);
+        int n = int(incidentStart[v + 1] - incidentStart[v]);
+        int boundaryCount = 0;
+        for (uint32_t k = incidentStart[v]; k < incidentStart[v + 1]; k++) {
+            uint32_t h = incident[k];
+            boundaryCount += mesh.heSym[h] == NONE ? 1 : 0;
+            boundaryCount += mesh.heSym[mesh.heNext[h]] == NONE ? 1 : 0;
+        }
+        if (boundaryCount == 2) {
+            terms.emplace_back(v, 6.0f / 8.0f);
+            for (uint32_t k = incidentStart[v]; k < incidentStart[v + 1]; k++) {
+                uint32_t h = incident[k];
+                uint32_t next = mesh.heNext[h];
+                if (mesh.heSym[h] == NONE) {
+                    terms.emplace_back(mesh.heVertex[prev[h]], 1.0f / 8.0f);
+                }
+                if (mesh.heSym[next] == NONE) {
+                    terms.emplace_back(mesh.heVertex[next], 1.0f / 8.0f);
+                }
+            }
+        } else if (boundaryCount == 0 && n > 0) {
+            float inv = 1.0f / float(n * n);
+            terms.emplace_back(v, float(n - 2) / float(n));
+            for (uint32_t k = incidentStart[v]; k < incidentStart[v + 1]; k++) {
+                uint32_t h = incident[k];
+                addEdge(terms, edgeOf[h], inv);
+                addFace(terms, mesh.heFace[h], inv);
+            }
+        } else {
+            terms.emplace_back(v, 1.0f);
+        }
+    });
+}
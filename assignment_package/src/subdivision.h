@@ -0,0 +1,58 @@
+#pragma once
+#include "arena.h"
+#include "halfedgemesh.h"
+#include "stenciltable.h"
+
+// Catmull-Clark subdivision in O(V + E + F).
+// The constructor numbers the undirected edges of the input, caches
+// the previous halfedge of every halfedge and groups the halfedges by
+// the vertex they point to. refine() then fills dense arrays for face
+// points, edge points and vertex points and writes the subdivided mesh
+// into arrays sized exactly from the input counts.
+//
+// The per-edge and per-vertex tables live in the thread's scratch arena
+// for as long as the CatmullClark does, so subdividing level after level
+// reuses the same memory instead of going back to the heap.
+//
+// Every phase writes each output element from a single loop iteration
+// and sums in a fixed order, so the result is byte-identical for any
+// thread count.
+//
+// Element layout of the output:
+//   vertices  [0, V)        smoothed input vertices, same ids as the input
+//             [V, V+E)      edge points, in edge order
+//             [V+E, V+E+F)  face points, in face order
+//   faces     one quad per input halfedge h, with id h
+//   halfedges 4h .. 4h+3 for the quad of h
+class CatmullClark
+{
+public:
+    // threads <= 0 uses every core, 1 runs serially
+    CatmullClark(const HalfEdgeMesh &mesh, int threads = 0);
+
+    void refine(HalfEdgeMesh &out) const; // writes the subdivided mesh into out
+    void refineTopology(HalfEdgeMesh &out) const; // connectivity and face colors of out
+    // positions of the subdivided vertices for the given input positions
+    void refinePositions(const std::vector<glm::vec3> &cagePos, std::vector<glm::vec3> &out) const;
+    // weights of the subdivided vertices over the input vertices, same rules as refinePositions
+    void refineStencils(StencilTable &out) const;
+
+    int numEdges() const; // number of undirected edges of the input
+
+private:
+    const HalfEdgeMesh &mesh; // mesh being subdivided
+    int threads; // requested thread count
+    ScratchScope scratch; // keeps the arena behind the tables below alive
+    ArenaVector<uint32_t> prev; // previous halfedge of every halfedge
+    ArenaVector<uint32_t> edgeOf; // undirected edge of every halfedge
+    ArenaVector<uint32_t> edgeHalfEdge; // first halfedge of every edge
+    ArenaVector<uint32_t> incidentStart; // start of each vertex's range in incident
+    ArenaVector<uint32_t> incident; // halfedges pointing to each vertex, sorted by index
+
+    void numberEdges();
+    void groupIncident();
+
+    void computeFacePoints(const std::vector<glm::vec3> &cagePos, std::vector<glm::vec3> &out) const;
+    void computeEdgePoints(const std::vector<glm::vec3> &cagePos, std::vector<glm::vec3> &out) const;
+    void computeVertexPoints(const std::vector<glm::vec3> &cagePos, std::vector<glm::vec3> &out) const;
+};
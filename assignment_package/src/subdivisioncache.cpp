@@ -0,0 +1,117 @@
+#include "subdivisioncache.h"
+#include "subdivision.h"
+#include "jobsystem.h"
+
+SubdivisionCache::SubdivisionCache(const HalfEdgeMesh &cage)
+    : cage(cage), threads(0), levels()
+{}
+
+void SubdivisionCache::setThreads(int threads) {
+    this->threads = threads;
+}
+
+void SubdivisionCache::invalidate() {
+    levels.clear();
+}
+
+int SubdivisionCache::cachedLevels() const {
+    return int(levels.size());
+}
+
+const HalfEdgeMesh &SubdivisionCache::topology(int level) {
+    return ensureLevel(level).topology;
+}
+
+const StencilTable &SubdivisionCache::stencils(int level) {
+    return ensureLevel(level).stencils;
+}
+
+const std::vector<uint32_t> &SubdivisionCache::cageFaces(int level) {
+    return ensureLevel(level).cageFaces;
+}
+
+const std::vector<uint32_t> &SubdivisionCache::refinedFaceStart(int level) {
+    return ensureLevel(level).refinedFaceStart;
+}
+
+const std::vector<uint32_t> &SubdivisionCache::refinedFaces(int level) {
+    return ensureLevel(level).refinedFaces;
+}
+
+// builds every missing level up to the requested one, each from the one below
+SubdivisionCache::Level &SubdivisionCache::ensureLevel(int level) {
+    while (int(levels.size()) < level) {
+        const Level *coarse = levels.empty() ? nullptr : levels.back().get();
+        const HalfEdgeMesh &coarseMesh = coarse ? coarse->topology : cage;
+        uPtr<Level> fine = mkU<Level>();
+        Level &l = *fine;
+        CatmullClark cc(coarseMesh, threads);
+
+        // topology, stencils and face parents only read the coarse level,
+        // so they run side by side; composing and indexing the stencils
+        // waits for the stencils
+        TaskGraph graph;
+        graph.add([&]() {
+            cc.refineTopology(l.topology);
+        });
+        int stencils = graph.add([&]() {
+            cc.refineStencils(l.stencils);
+        });
+        graph.add([&]() {
+            // refined face h comes from the coarse face of halfedge h
+            const std::vector<uint32_t> &parents = coarseMesh.heFace;
+            l.cageFaces.resize(parents.size());
+            for (size_t h = 0; h < parents.size(); h++) {
+                l.cageFaces[h] = coarse ? coarse->cageFaces[parents[h]] : parents[h];
+            }
+
+            // the inverse, by counting the refined faces of each cage face
+            l.refinedFaceStart.assign(cage.numFaces() + 1, 0);
+            for (uint32_t c : l.cageFaces) {
+                l.refinedFaceStart[c + 1] += 1;
+            }
+            for (int c = 0; c < cage.numFaces(); c++) {
+                l.refinedFaceStart[c + 1] += l.refinedFaceStart[c];
+            }
+            std::vector<uint32_t> fill(l.refinedFaceStart.begin(), l.refinedFaceStart.end() - 1);
+            l.refinedFaces.resize(l.cageFaces.size());
+            for (size_t f = 0; f < l.cageFaces.size(); f++) {
+                l.refinedFaces[fill[l.cageFaces[f]]++] = uint32_t(f);
+            }
+        });
+        int influence = graph.add([&]() {
+            if (coarse) {
+                l.stencils.compose(coarse->stencils, threads);
+            }
+            l.stencils.buildInfluence();
+        });
+        graph.precede(stencils, influence);
+        graph.run();
+        levels.push_back(std::move(fine));
+    }
+    return *levels[level - 1];
+}
+
+void SubdivisionCache::refine(int level, HalfEdgeMesh &out) {
+    const Level &l = ensureLevel(level);
+    out.heNext = l.topology.heNext;
+    out.heSym = l.topology.heSym;
+    out.heVertex = l.topology.heVertex;
+    out.heFace = l.topology.heFace;
+    out.vertHalfEdge = l.topology.vertHalfEdge;
+    out.faceHalfEdge = l.topology.faceHalfEdge;
+    l.stencils.evaluate(cage.vertPos, out.vertPos, threads);
+    updateColors(level, out);
+}
+
+void SubdivisionCache::updateVertex(int level, uint32_t v, HalfEdgeMesh &out) {
+    ensureLevel(level).stencils.evaluateAffected(v, cage.vertPos, out.vertPos);
+}
+
+void SubdivisionCache::updateColors(int level, HalfEdgeMesh &out) {
+    const std::vector<uint32_t> &parents = ensureLevel(level).cageFaces;
+    out.faceColor.resize(parents.size());
+    for (size_t f = 0; f < parents.size(); f++) {
+        out.faceColor[f] = cage.faceColor[parents[f]];
+    }
+}
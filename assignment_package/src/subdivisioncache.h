@@ -0,0 +1,51 @@
+#pragma once
+#include "smartpointerhelp.h"
+#include "halfedgemesh.h"
+#include "stenciltable.h"
+
+// Catmull-Clark refinement levels of a cage that stays editable.
+// Level k keeps the topology of the cage subdivided k times and the
+// stencils of its vertices over the cage vertices. A level is built
+// from the level below it the first time it is asked for, and kept
+// until the topology of the cage changes; moving cage vertices or
+// recoloring faces only needs the cached stencils and face parents.
+class SubdivisionCache
+{
+public:
+    SubdivisionCache(const HalfEdgeMesh &cage);
+
+    void setThreads(int threads); // threads used to build levels, <= 0 uses every core
+    void invalidate(); // drops every level, call when cage topology changes
+    int cachedLevels() const; // number of levels currently built
+
+    // level >= 1; builds the missing levels up to it
+    const HalfEdgeMesh &topology(int level); // positions are not filled in
+    const StencilTable &stencils(int level);
+    const std::vector<uint32_t> &cageFaces(int level); // cage face of every refined face
+    // refined faces of every cage face in CSR form: those of cage face f are
+    // [refinedFaceStart[f], refinedFaceStart[f + 1]) of refinedFaces, in order
+    const std::vector<uint32_t> &refinedFaceStart(int level);
+    const std::vector<uint32_t> &refinedFaces(int level);
+
+    // writes the cage subdivided to level into out: topology, positions and colors
+    void refine(int level, HalfEdgeMesh &out);
+    // refreshes the positions of out after cage vertex v has moved
+    void updateVertex(int level, uint32_t v, HalfEdgeMesh &out);
+    // refreshes the face colors of out from the cage colors
+    void updateColors(int level, HalfEdgeMesh &out);
+
+private:
+    struct Level {
+        HalfEdgeMesh topology; // connectivity of the level
+        StencilTable stencils; // vertex weights over the cage vertices
+        std::vector<uint32_t> cageFaces; // cage face of every face
+        std::vector<uint32_t> refinedFaceStart; // start of each cage face's range in refinedFaces
+        std::vector<uint32_t> refinedFaces; // faces of the level grouped by cage face
+    };
+
+    const HalfEdgeMesh &cage; // editable base mesh
+    int threads; // requested thread count
+    std::vector<uPtr<Level>> levels; // levels[k - 1] is level k
+
+    Level &ensureLevel(int level); // builds the missing levels up to level
+};
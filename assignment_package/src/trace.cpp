@@ -0,0 +1,210 @@
+#include "trace.h"
+#include <algorithm>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+std::atomic<int> Trace::listeners(0);
+
+namespace {
+
+struct Event
+{
+    const char *name;
+    int64_t begin; // nanoseconds, steady clock
+    int64_t end;
+};
+
+// events of one thread; a buffer outlives its thread and is handed to
+// the next new thread, so short-lived workers share a few rows
+struct ThreadEvents
+{
+    int tid;
+    bool inUse;
+    std::vector<Event> events;
+};
+
+struct Registry
+{
+    std::mutex lock;
+    std::vector<std::unique_ptr<ThreadEvents>> threads;
+    std::string path;
+    FILE *file = nullptr; // open while a trace is recorded, start() opens it so a bad path fails early
+    int captures = 0; // running TraceCaptures
+    std::string message;
+    int64_t origin = 0; // start of the trace, timestamps are relative to it
+};
+
+Registry &registry() {
+    static Registry instance;
+    return instance;
+}
+
+// gives the buffer back when its thread exits
+struct ThreadSlot
+{
+    ThreadEvents *events = nullptr;
+
+    ~ThreadSlot() {
+        if (events) {
+            std::lock_guard<std::mutex> guard(registry().lock);
+            events->inUse = false;
+        }
+    }
+};
+
+thread_local ThreadSlot slot;
+
+ThreadEvents &threadEvents() {
+    if (!slot.events) {
+        Registry &r = registry();
+        std::lock_guard<std::mutex> guard(r.lock);
+        for (const std::unique_ptr<ThreadEvents> &t : r.threads) {
+            if (!t->inUse) {
+                slot.events = t.get();
+                break;
+            }
+        }
+        if (!slot.events) {
+            r.threads.emplace_back(new ThreadEvents{int(r.threads.size()) + 1, false, {}});
+            slot.events = r.threads.back().get();
+        }
+        slot.events->inUse = true;
+    }
+    return *slot.events;
+}
+
+void writeMicroseconds(FILE *file, int64_t ns) {
+    std::fprintf(file, "%lld.%03d", (long long)(ns / 1000), int(ns % 1000));
+}
+
+void writeName(FILE *file, const char *name) {
+    for (const char *c = name; *c; c++) {
+        if (*c == '"' || *c == '\\') {
+            std::fputc('\\', file);
+        }
+        std::fputc(*c, file);
+    }
+}
+
+// nobody needs the events anymore once the trace and every capture are done
+void releaseEvents(Registry &r) {
+    if (!r.file && r.captures == 0) {
+        for (const std::unique_ptr<ThreadEvents> &t : r.threads) {
+            t->events.clear();
+        }
+    }
+}
+
+} // namespace
+
+bool Trace::start(const std::string &path) {
+    Registry &r = registry();
+    std::lock_guard<std::mutex> guard(r.lock);
+    if (r.file) {
+        r.message = "a trace is already recorded to " + r.path;
+        return false;
+    }
+    r.file = std::fopen(path.c_str(), "wb");
+    if (!r.file) {
+        r.message = "cannot open " + path;
+        return false;
+    }
+    r.path = path;
+    r.message.clear();
+    r.origin = now();
+    listeners.fetch_add(1);
+    return true;
+}
+
+bool Trace::stop() {
+    Registry &r = registry();
+    std::lock_guard<std::mutex> guard(r.lock);
+    if (!r.file) {
+        r.message = "no trace is recorded";
+        return false;
+    }
+    listeners.fetch_sub(1);
+
+    FILE *file = r.file;
+    r.file = nullptr;
+    std::fprintf(file, "{\"traceEvents\":[\n");
+    bool first = true;
+    for (const std::unique_ptr<ThreadEvents> &t : r.threads) {
+        for (const Event &e : t->events) {
+            // events from before start() were kept for a capture
+            if (e.begin < r.origin) {
+                continue;
+            }
+            std::fprintf(file, "%s{\"name\":\"", first ? "" : ",\n");
+            writeName(file, e.name);
+            std::fprintf(file, "\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":", t->tid);
+            writeMicroseconds(file, e.begin - r.origin);
+            std::fprintf(file, ",\"dur\":");
+            writeMicroseconds(file, e.end - e.begin);
+            std::fprintf(file, "}");
+            first = false;
+        }
+    }
+    releaseEvents(r);
+    std::fprintf(file, "\n],\"displayTimeUnit\":\"ms\"}\n");
+    bool ok = std::fclose(file) == 0;
+    if (!ok) {
+        r.message = "cannot write " + r.path;
+    }
+    return ok;
+}
+
+const std::string &Trace::error() {
+    return registry().message;
+}
+
+void Trace::record(const char *name, int64_t begin, int64_t end) {
+    threadEvents().events.push_back(Event{name, begin, end});
+}
+
+int Trace::currentThread() {
+    return threadEvents().tid;
+}
+
+TraceCapture::TraceCapture()
+    : marks(), running(true)
+{
+    Registry &r = registry();
+    std::lock_guard<std::mutex> guard(r.lock);
+    marks.reserve(r.threads.size());
+    for (const std::unique_ptr<ThreadEvents> &t : r.threads) {
+        marks.push_back(t->events.size());
+    }
+    r.captures += 1;
+    Trace::listeners.fetch_add(1);
+}
+
+TraceCapture::~TraceCapture() {
+    if (running) {
+        std::vector<TraceEvent> unused;
+        finish(unused);
+    }
+}
+
+void TraceCapture::finish(std::vector<TraceEvent> &out) {
+    if (!running) {
+        return;
+    }
+    running = false;
+    Registry &r = registry();
+    std::lock_guard<std::mutex> guard(r.lock);
+    Trace::listeners.fetch_sub(1);
+    r.captures -= 1;
+    for (size_t i = 0; i < r.threads.size(); i++) {
+        const ThreadEvents &t = *r.threads[i];
+        // threads registered during the capture start from their first event
+        size_t first = i < marks.size() ? std::min(marks[i], t.events.size()) : 0;
+        for (size_t k = first; k < t.events.size(); k++) {
+            const Event &e = t.events[k];
+            out.push_back(TraceEvent{e.name, t.tid, e.begin, e.end});
+        }
+    }
+    releaseEvents(r);
+}
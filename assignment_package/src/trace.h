@@ -0,0 +1,105 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Scoped timers written as Chrome trace_event JSON, viewable in
+// chrome://tracing or ui.perfetto.dev.
+// TRACE_SCOPE("name") records one complete event from that line to the
+// end of the enclosing block, on the thread it runs on. Every thread
+// appends to its own buffer, so recording takes no lock. While neither a
+// trace nor a TraceCapture is active a scope costs one relaxed atomic
+// load; defining NO_TRACE compiles the scopes out.
+//
+// Names must be string literals, only the pointer is kept. start(),
+// stop() and captures must begin and end while no traced work is running.
+
+// one recorded scope
+struct TraceEvent
+{
+    const char *name;
+    int thread; // small id of the recording thread, the "tid" in the file
+    int64_t begin; // nanoseconds, steady clock
+    int64_t end;
+};
+
+class Trace
+{
+public:
+    // creates path and records until stop(), false if it cannot be
+    // created or a trace is already recorded
+    static bool start(const std::string &path);
+    // writes the recorded events, false if they cannot be written
+    static bool stop();
+    static const std::string &error(); // why start() or stop() failed
+
+    static bool active() {
+        return listeners.load(std::memory_order_relaxed) > 0;
+    }
+
+    // steady clock in nanoseconds
+    static int64_t now() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    // adds a complete event to the calling thread's buffer
+    static void record(const char *name, int64_t begin, int64_t end);
+
+    static int currentThread(); // id the calling thread records under
+
+private:
+    friend class TraceCapture;
+    static std::atomic<int> listeners; // the trace file and every running capture
+};
+
+// records the time from construction to destruction if a trace is active
+class TraceScope
+{
+public:
+    explicit TraceScope(const char *name)
+        : name(Trace::active() ? name : nullptr), begin(this->name ? Trace::now() : 0)
+    {}
+
+    ~TraceScope() {
+        if (name) {
+            Trace::record(name, begin, Trace::now());
+        }
+    }
+
+    TraceScope(const TraceScope &) = delete;
+    TraceScope &operator=(const TraceScope &) = delete;
+
+private:
+    const char *name; // nullptr if nothing is recorded
+    int64_t begin;
+};
+
+// Collects the scopes of every thread in memory from construction until
+// finish(), whether or not a trace file is recorded. Captures may nest.
+class TraceCapture
+{
+public:
+    TraceCapture();
+    ~TraceCapture(); // finishes if finish() was not called
+
+    // stops collecting and appends the events since construction to out
+    void finish(std::vector<TraceEvent> &out);
+
+    TraceCapture(const TraceCapture &) = delete;
+    TraceCapture &operator=(const TraceCapture &) = delete;
+
+private:
+    std::vector<size_t> marks; // size of every thread's buffer at construction
+    bool running;
+};
+
+#ifdef NO_TRACE
+#define TRACE_SCOPE(name) ((void)0)
+#else
+#define TRACE_CONCAT_(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_(a, b)
+#define TRACE_SCOPE(name) TraceScope TRACE_CONCAT(traceScope, __LINE__)(name)
+#endif
@@ -1,17 +1,34 @@
 #include "vertex.h"
+#include "halfedgemesh.h"
 
 Vertex::Vertex()
-    : QListWidgetItem()
-{
-    id = lastVertex++;
-    this->setText(QString::number(this->id));
+    : mesh(nullptr), index(HalfEdgeMesh::NONE), generation(0)
+{}
 
+Vertex::Vertex(HalfEdgeMesh *mesh, uint32_t index)
+    : mesh(mesh), index(index), generation(mesh ? mesh->vertexGeneration(index) : 0)
+{}
+
+glm::vec3 &Vertex::pos() const {
+    return mesh->vertPos[index];
+}
+
+HalfEdge Vertex::halfedge() const {
+    return HalfEdge(mesh, mesh->vertHalfEdge[index]);
+}
+
+int Vertex::id() const {
+    return int(index);
+}
+
+bool Vertex::isValid() const {
+    return mesh != nullptr && mesh->isVertexAlive(index) && mesh->vertexGeneration(index) == generation;
+}
+
+bool Vertex::operator==(const Vertex &other) const {
+    return mesh == other.mesh && index == other.index && generation == other.generation;
 }
 
-// constructor with initial positin and halfedge
-Vertex::Vertex(float x, float y, float z, HalfEdge *edge)
-    : QListWidgetItem(), pos(glm::vec3(x, y, z)), halfedge(edge)
-{
-    id = lastVertex++;
-    this->setText(QString::number(this->id));
+bool Vertex::operator!=(const Vertex &other) const {
+    return !(*this == other);
 }
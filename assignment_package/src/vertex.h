@@ -1,21 +1,24 @@
 #pragma once
 #include <glm/glm.hpp>
-#include <halfedge.h>
-#include <QListWidgetItem>
+#include <cstdint>
 
+class HalfEdgeMesh;
 class HalfEdge;
 
-static int lastVertex;
-
-class Vertex : public QListWidgetItem
+// Lightweight view of a vertex stored in a HalfEdgeMesh
+class Vertex
 {
 public:
-    Vertex();
-    // constructor with initial positin and halfedge
-    Vertex(float x, float y, float z, HalfEdge *edge);
-    glm::vec3 pos; // vertex position
-    HalfEdge *halfedge; // halfedge that points to the vertex
-    int id; // unique id for vertex
-
+    Vertex(); // invalid vertex
+    Vertex(HalfEdgeMesh *mesh, uint32_t index);
+    glm::vec3 &pos() const; // vertex position
+    HalfEdge halfedge() const; // halfedge that points to the vertex
+    int id() const; // unique id for vertex
+    bool isValid() const; // false once the vertex is removed, even if its slot is reused
+    bool operator==(const Vertex &other) const;
+    bool operator!=(const Vertex &other) const;
 
+    HalfEdgeMesh *mesh; // mesh that stores the vertex
+    uint32_t index; // index of the vertex in the mesh arrays
+    uint32_t generation; // generation of the slot when the view was made
 };
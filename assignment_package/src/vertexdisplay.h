@@ -1,19 +1,19 @@
 #pragma once
 #include "drawable.h"
-#include "vertex.h"
+#include "halfedgemesh.h"
 #include <vector>
 
 class VertexDisplay : public Drawable
 {
 protected:
     // vertex this object represents
-    Vertex *representedVertex = nullptr;
+    Vertex representedVertex;
 
 public:
     VertexDisplay(OpenGLContext*);
     ~VertexDisplay();
     GLenum drawMode() override;
     virtual void create() override;
-    void updateVertex(Vertex*); // updates the represented vertex
+    void updateVertex(Vertex); // updates the represented vertex
 };
 